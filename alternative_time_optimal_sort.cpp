@@ -1,9 +1,11 @@
 #include <iostream>
+#include <cstdlib>
 #include <vector>
 #include <thread>
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include "alternative_time_optimal_sort.h"
 using namespace std;
 // Structure for arguments
 struct Arguments {
@@ -145,7 +147,40 @@ void runAlternateTimeOptimalSort() {
 }
 
 
-int main() {
+// Run a worker pool version on each size, checking it against std::sort.
+// sortFn(arr, pool) sorts arr in place and returns the time in ms.
+template <class Sort>
+void runPoolVersion(const string& title, const vector<int>& sizes, WorkerPool& pool, Sort sortFn) {
+    cout << "=== " << title << " ===" << endl;
+    cout << "Size\tTime(ms)\tVerification" << endl;
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> arrCopy = arr;
+        double time = sortFn(arr, pool);
+        bool sorted = isSorted(arr);
+
+        sort(arrCopy.begin(), arrCopy.end());
+        bool correctSort = arr == arrCopy;
+        cout << size << "\t" << time << " ms\t" 
+                  << (sorted && correctSort ? "Correct" : "Incorrect") << endl;
+    }
+    cout << endl;
+}
+
+
+// Optional argument: number of worker pool threads (default: one per core)
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
     runAlternateTimeOptimalSort();
+
+    // The pool is created once and reused for every size
+    WorkerPool pool(threads);
+    string threadCount = to_string(pool.size());
+    vector<int> poolSizes = {10, 20, 30, 50, 1000, 10000};
+    runPoolVersion("Alternate Time Optimal Sort (worker pool, " + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, WorkerPool& pool) { return alternateTimeOptimalSorting(arr, pool); });
+    runPoolVersion(string("Alternate Time Optimal Sort (") + (detectSimdLevel() >= SIMD_AVX2 ? "AVX2" : "Scalar")
+                   + " triplet kernel, " + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, WorkerPool& pool) { return simdAlternateTimeOptimalSorting(arr, pool); });
     return 0;
 }
\ No newline at end of file
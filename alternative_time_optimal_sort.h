@@ -0,0 +1,225 @@
+#ifndef ALTERNATIVE_TIME_OPTIMAL_SORT_H
+#define ALTERNATIVE_TIME_OPTIMAL_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "perf_counters.h"
+#include "simd_kernels.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Sorts the triplet around center (or the remaining pair at either end).
+// min/mid/max come from min and max only, so the mid cannot overflow.
+// Returns 1 if the triplet (or pair) was out of order.
+template <class T>
+inline int sortTriplet(T* arr, long n, long center) {
+    if (center - 1 < 0) {
+        if (center + 1 < n && arr[center + 1] < arr[center]) {
+            std::swap(arr[center], arr[center + 1]);
+            return 1;
+        }
+        return 0;
+    }
+    else if (center + 1 >= n) {
+        if (arr[center] < arr[center - 1]) {
+            std::swap(arr[center], arr[center - 1]);
+            return 1;
+        }
+        return 0;
+    }
+    T a = arr[center - 1], b = arr[center], c = arr[center + 1];
+    T lo = std::min(a, b), hi = std::max(a, b);
+    arr[center - 1] = std::min(lo, c);
+    arr[center] = std::max(lo, std::min(hi, c));
+    arr[center + 1] = std::max(hi, c);
+    return (b < a) | (c < b);
+}
+
+// First center of round i, following the (i + 1) % 3 rotation
+inline long firstCenter(long round) {
+    long remainder = (round + 1) % 3;
+    if (remainder == 0) {
+        return 2;
+    }
+    else if (remainder == 1) {
+        return 0;
+    }
+    return 1;
+}
+
+// Alternate time optimal sorting on a persistent worker pool. Each worker
+// sorts a contiguous chunk of the stride-3 triplets of a round, then waits on
+// the pool barrier before the next round. In adaptive mode it stops after
+// three rounds in a row without an exchange: together they cover every
+// center offset mod 3, so every adjacent pair has been seen in order.
+// A profiler, if given, gets hardware counts per round and worker.
+template <class T>
+inline SortStats alternateTimeOptimalSortingWithStats(std::vector<T>& arr, WorkerPool& pool, bool adaptive,
+                                                      RoundProfiler* profiler = nullptr) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    T* data = arr.data();
+    ExchangeCounter counter(pool.size());
+    long executed = 0;
+    if (profiler) profiler->prepare(pool.size(), n > 0 ? n - 1 : 0);
+
+    pool.run([&](int worker) {
+        if (profiler) profiler->start(worker);
+        long quietRounds = 0;
+        long i = 1;
+        // For n - 1 rounds
+        for (; i < n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            long first = firstCenter(i);
+            long centers = first < n ? (n - 1 - first) / 3 + 1 : 0;
+            long begin, end;
+            pool.chunk(centers, worker, begin, end);
+            long swaps = 0;
+            for (long k = begin; k < end; k++) {
+                swaps += sortTriplet(data, n, first + 3 * k);
+            }
+            counter.record(worker, i, swaps);
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+            if (profiler) profiler->endRound(worker, i);
+
+            if (adaptive) {
+                quietRounds = counter.roundTotal(i) == 0 ? quietRounds + 1 : 0;
+                if (quietRounds == 3) {
+                    i++;
+                    break;
+                }
+            }
+        }
+        if (worker == 0) {
+            executed = i - 1;
+        }
+        if (profiler) profiler->stop(worker, i - 1);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    SortStats stats = {duration.count(), executed, counter.total()};
+    return stats;
+}
+
+inline double alternateTimeOptimalSorting(std::vector<int>& arr, WorkerPool& pool) {
+    return alternateTimeOptimalSortingWithStats(arr, pool, false).milliseconds;
+}
+
+// Sorts the triplets [begin, end) of a round whose first center is first.
+// Interior triplets are packed back to back and go through the SIMD kernel;
+// only the pairs at either end of the array stay scalar.
+inline void sortTripletRange(int* data, long n, long first, long begin, long end) {
+    // Interior triplets have both neighbours of the center in range
+    if (begin < end && first + 3 * begin == 0) {
+        sortTriplet(data, n, 0);
+        begin++;
+    }
+    if (begin < end && first + 3 * (end - 1) + 1 >= n) {
+        sortTriplet(data, n, first + 3 * (end - 1));
+        end--;
+    }
+    if (begin < end) {
+        sortTriplets(data + first + 3 * begin - 1, end - begin);
+    }
+}
+
+// Triplets of round i whose centers lie in [begin, end)
+inline void sortTripletCenters(int* data, long n, long round, long begin, long end) {
+    // Centers are first + 3k
+    long first = firstCenter(round);
+    long from = begin > first ? (begin - first + 2) / 3 : 0;
+    long to = std::min(end, n) > first ? (std::min(end, n) - first + 2) / 3 : 0;
+    if (from < to) {
+        sortTripletRange(data, n, first, from, to);
+    }
+}
+
+// Alternate time optimal sorting without the round barrier. Worker w owns the
+// elements of block w and sorts the triplets centered on them, so a triplet
+// reaches at most one element into either neighbour's block. Blocks hold at
+// least two elements (only the last may be shorter): around a lone interior
+// element, triplets of consecutive rounds would reach two blocks away, past
+// the neighbours the worker waits for. Round i + 1 starts once both
+// neighbours have finished round i (NeighbourClock); the triplets of one
+// round never overlap, so that is all the ordering the schedule needs. Same
+// n - 1 rounds with the SIMD triplet kernel and no adaptive mode.
+inline double wavefrontAlternateTimeOptimalSorting(std::vector<int>& arr, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+    long size = std::max(2L, (n + pool.size() - 1) / pool.size());
+    NeighbourClock clock(pool.size());
+
+    pool.run([&](int worker) {
+        long begin = std::min(n, worker * size), end = std::min(n, begin + size);
+
+        // For n - 1 rounds
+        for (long i = 1; i < n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            clock.waitForNeighbours(worker, i - 1);
+            SORT_TRACE_BEGIN("work", i);
+            sortTripletCenters(data, n, i, begin, end);
+            SORT_TRACE_END("work", i);
+            clock.finish(worker, i);
+            SORT_TRACE_END("round", i);
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Alternate time optimal sorting of a small tile on the calling thread, with
+// the SIMD triplet kernel. Same n - 1 rounds; used as the base case of the
+// hybrid sort, where a tile fits in L1 and a barrier would cost more than
+// the whole round. Fewer rounds can be asked for, as for the odd-even tile.
+inline void alternateTimeOptimalSortingTile(int* data, long n, long rounds = -1) {
+    if (rounds < 0) {
+        rounds = n > 0 ? n - 1 : 0;
+    }
+    for (long i = 1; i <= rounds; i++) {
+        long first = firstCenter(i);
+        long centers = first < n ? (n - 1 - first) / 3 + 1 : 0;
+        sortTripletRange(data, n, first, 0, centers);
+    }
+}
+
+// Alternate time optimal sorting with the SIMD triplet kernel. Same schedule
+// as alternateTimeOptimalSorting; each worker's chunk of the triplets of a
+// round is one sortTripletRange call.
+inline double simdAlternateTimeOptimalSorting(std::vector<int>& arr, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+
+    pool.run([&](int worker) {
+        // For n - 1 rounds
+        for (long i = 1; i < n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            long first = firstCenter(i);
+            long centers = first < n ? (n - 1 - first) / 3 + 1 : 0;
+            long begin, end;
+            pool.chunk(centers, worker, begin, end);
+            sortTripletRange(data, n, first, begin, end);
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef BATCH_SORT_H
+#define BATCH_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include "alternative_time_optimal_sort.h"
+#include "hybrid_sort.h"
+#include "simd_kernels.h"
+#include "worker_pool.h"
+
+// Batched sorting of many independent small arrays of equal length. Instead
+// of vectorizing inside one array, a batch of 8 (AVX2) or 16 (AVX-512)
+// arrays is transposed so element i of every array in the batch shares one
+// register: row i of the batch holds element i of each lane. A compare-exchange
+// of elements i and j is then one min and one max of rows i and j, sorting
+// the whole batch at once, with no shuffles and no branches.
+
+// Compare-exchanges of the odd-even or mod-3 schedule for arrays of length
+// n, in order. Exchanges within a round are independent; a mod-3 triplet is
+// the three exchanges (a, b), (b, c), (a, b).
+inline std::vector<std::pair<int, int> > batchNetwork(long n, TileNetwork network) {
+    std::vector<std::pair<int, int> > exchanges;
+    if (network == TILE_ALTERNATE) {
+        for (long i = 1; i < n; i++) {
+            for (long center = firstCenter(i); center < n; center += 3) {
+                int a = static_cast<int>(center);
+                if (center == 0) {
+                    if (n > 1) exchanges.push_back(std::make_pair(0, 1));
+                } else if (center + 1 >= n) {
+                    exchanges.push_back(std::make_pair(a - 1, a));
+                } else {
+                    exchanges.push_back(std::make_pair(a - 1, a));
+                    exchanges.push_back(std::make_pair(a, a + 1));
+                    exchanges.push_back(std::make_pair(a - 1, a));
+                }
+            }
+        }
+    } else {
+        for (long i = 1; i <= n; i++) {
+            for (long k = (i % 2 == 1) ? 0 : 1; k + 1 < n; k += 2) {
+                exchanges.push_back(std::make_pair(static_cast<int>(k), static_cast<int>(k + 1)));
+            }
+        }
+    }
+    return exchanges;
+}
+
+// ----- Network kernels -----
+// Run the exchanges on a transposed batch: rows of lanes ints, one per
+// element. The width of a row is the kernel's register width.
+
+inline void applyBatchNetworkScalar(int* rows, const std::pair<int, int>* exchanges, long count) {
+    for (long e = 0; e < count; e++) {
+        int* a = rows + 8 * exchanges[e].first;
+        int* b = rows + 8 * exchanges[e].second;
+        for (int lane = 0; lane < 8; lane++) {
+            int lo = std::min(a[lane], b[lane]);
+            int hi = std::max(a[lane], b[lane]);
+            a[lane] = lo;
+            b[lane] = hi;
+        }
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+__attribute__((target("avx2")))
+inline void applyBatchNetworkAVX2(int* rows, const std::pair<int, int>* exchanges, long count) {
+    for (long e = 0; e < count; e++) {
+        __m256i* a = reinterpret_cast<__m256i*>(rows + 8 * exchanges[e].first);
+        __m256i* b = reinterpret_cast<__m256i*>(rows + 8 * exchanges[e].second);
+        __m256i va = _mm256_loadu_si256(a), vb = _mm256_loadu_si256(b);
+        _mm256_storeu_si256(a, _mm256_min_epi32(va, vb));
+        _mm256_storeu_si256(b, _mm256_max_epi32(va, vb));
+    }
+}
+
+// GCC 12 flags the undefined passthrough operand inside the AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+inline void applyBatchNetworkAVX512(int* rows, const std::pair<int, int>* exchanges, long count) {
+    for (long e = 0; e < count; e++) {
+        int* a = rows + 16 * exchanges[e].first;
+        int* b = rows + 16 * exchanges[e].second;
+        __m512i va = _mm512_loadu_si512(a), vb = _mm512_loadu_si512(b);
+        _mm512_storeu_si512(a, _mm512_min_epi32(va, vb));
+        _mm512_storeu_si512(b, _mm512_max_epi32(va, vb));
+    }
+}
+#pragma GCC diagnostic pop
+#endif
+
+typedef void (*BatchKernel)(int*, const std::pair<int, int>*, long);
+
+// Arrays per batch (lanes of the register) for a given instruction set
+inline int batchLanes(SimdLevel level) {
+    return level >= SIMD_AVX512 ? 16 : 8;
+}
+
+// Network kernel for a given instruction set; SSE4.1 CPUs run the scalar one
+inline BatchKernel batchKernel(SimdLevel level) {
+#ifdef SIMD_KERNELS_X86
+    if (level >= SIMD_AVX512) {
+        return applyBatchNetworkAVX512;
+    }
+    if (level >= SIMD_AVX2) {
+        return applyBatchNetworkAVX2;
+    }
+#else
+    (void)level;
+#endif
+    return applyBatchNetworkScalar;
+}
+
+// Sorts count arrays of length n stored back to back in data, lanes arrays
+// at a time: each worker transposes a batch into its row buffer, runs the
+// network on it and transposes it back. A short last batch leaves its spare
+// lanes unused. level picks the kernel, SIMD_SCALAR included, so the
+// benchmark can compare them.
+inline double batchSort(int* data, long count, long n, WorkerPool& pool, TileNetwork network, SimdLevel level) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    const int lanes = batchLanes(level);
+    const BatchKernel kernel = batchKernel(level);
+    const std::vector<std::pair<int, int> > exchanges = batchNetwork(n, network);
+    long batches = (count + lanes - 1) / lanes;
+
+    pool.run([&](int worker) {
+        std::vector<int> rows(n * lanes);
+        long begin, end;
+        pool.chunk(batches, worker, begin, end);
+        for (long b = begin; b < end; b++) {
+            int used = static_cast<int>(std::min<long>(lanes, count - b * lanes));
+            int* batch = data + b * lanes * n;
+            for (int lane = 0; lane < used; lane++) {
+                for (long i = 0; i < n; i++) {
+                    rows[i * lanes + lane] = batch[lane * n + i];
+                }
+            }
+            kernel(rows.data(), exchanges.data(), exchanges.size());
+            for (int lane = 0; lane < used; lane++) {
+                for (long i = 0; i < n; i++) {
+                    batch[lane * n + i] = rows[i * lanes + lane];
+                }
+            }
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Same with the best kernel of this CPU
+inline double batchSort(int* data, long count, long n, WorkerPool& pool, TileNetwork network) {
+    return batchSort(data, count, n, pool, network, detectSimdLevel());
+}
+
+#endif
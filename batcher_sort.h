@@ -0,0 +1,158 @@
+#ifndef BATCHER_SORT_H
+#define BATCHER_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <vector>
+#include "simd_kernels.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Batcher's merge networks on the worker pool. Unlike the transposition
+// engines they pair keys at every power of two distance, which brings the
+// round count from n down to log2(N) (log2(N) + 1) / 2 for N = n rounded up
+// to a power of two. One round is one stage of the network: its
+// compare-exchanges touch disjoint pairs, so each worker takes a chunk of
+// them and the stage ends on the pool barrier. The input is padded with
+// INT_MAX up to N, and the three levels whose pairs lie within 8 keys run in
+// registers (sortBlocksOf8) as a single round.
+
+enum BatcherNetwork { BATCHER_BITONIC, BATCHER_ODD_EVEN_MERGE };
+
+// Compare-exchange of the runs a[0, len) and b[0, len), element by element.
+// Branch free so the compiler vectorizes it.
+inline void compareExchangeRuns(int* a, int* b, long len, bool ascending) {
+    if (ascending) {
+        for (long t = 0; t < len; t++) {
+            int lo = std::min(a[t], b[t]), hi = std::max(a[t], b[t]);
+            a[t] = lo;
+            b[t] = hi;
+        }
+    } else {
+        for (long t = 0; t < len; t++) {
+            int lo = std::min(a[t], b[t]), hi = std::max(a[t], b[t]);
+            a[t] = hi;
+            b[t] = lo;
+        }
+    }
+}
+
+// Comparators [begin, end) of the bitonic stage with merge size k and stride
+// j. Comparator c pairs i and i + j, where i is c with a zero bit inserted at
+// position j; runs of j consecutive comparators share one direction.
+inline void bitonicStage(int* data, long k, long j, long begin, long end) {
+    long c = begin;
+    while (c < end) {
+        long i = ((c & ~(j - 1)) << 1) | (c & (j - 1));
+        long len = std::min(end - c, j - (c & (j - 1)));
+        compareExchangeRuns(data + i, data + i + j, len, (i & k) == 0);
+        c += len;
+    }
+}
+
+// Comparators of the odd-even merge stage with half merge size p and stride
+// k whose lower key lies in [begin, end). Pairs start at k % p and come in
+// groups of k every 2k keys; a group is skipped when it would pair keys of
+// two different merges, i.e. when its middle falls on a multiple of 2p.
+inline void oddEvenMergeStage(int* data, long size, long p, long k, long begin, long end) {
+    long offset = k % p;
+    end = std::min(end, size - k);
+    long first = std::max(begin, offset);
+    for (long g = offset + (first - offset) / (2 * k) * (2 * k); g < end; g += 2 * k) {
+        if ((g + k) % (2 * p) == 0) {
+            continue;
+        }
+        long lo = std::max(g, begin), hi = std::min(g + k, end);
+        if (lo < hi) {
+            compareExchangeRuns(data + lo, data + lo + k, hi - lo, true);
+        }
+    }
+}
+
+// Batcher sort on the pool; the exchange count is not tracked (swaps = -1)
+inline SortStats batcherSortWithStats(std::vector<int>& arr, WorkerPool& pool, BatcherNetwork network) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    long size = 1;
+    while (size < n) {
+        size *= 2;
+    }
+    // Padding keys sort behind every real key, so the first n are the answer
+    std::vector<int> padded;
+    int* data = arr.data();
+    if (size != n) {
+        padded.resize(size, INT_MAX);
+        std::copy(arr.begin(), arr.end(), padded.begin());
+        data = padded.data();
+    }
+    bool alternate = network == BATCHER_BITONIC;
+    long executed = 0;
+
+    pool.run([&](int worker) {
+        long round = 0;
+        long firstLevel = 2;
+        if (size >= 8) {
+            round++;
+            SORT_TRACE_BEGIN("round", round);
+            long begin, end;
+            pool.chunk(size / 8, worker, begin, end);
+            sortBlocksOf8(data, begin, end, alternate);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", round);
+            firstLevel = 16;
+        }
+
+        for (long k = firstLevel; k <= size; k *= 2) {
+            for (long j = k / 2; j > 0; j /= 2) {
+                round++;
+                SORT_TRACE_BEGIN("round", round);
+                long begin, end;
+                if (alternate) {
+                    pool.chunk(size / 2, worker, begin, end);
+                    bitonicStage(data, k, j, begin, end);
+                } else {
+                    pool.chunk(size, worker, begin, end);
+                    oddEvenMergeStage(data, size, k / 2, j, begin, end);
+                }
+                pool.barrier(worker);
+                SORT_TRACE_END("round", round);
+            }
+        }
+        if (worker == 0) {
+            executed = round;
+        }
+    });
+
+    if (data != arr.data()) {
+        std::copy(data, data + n, arr.begin());
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    SortStats stats = {duration.count(), executed, -1};
+    return stats;
+}
+
+inline double bitonicSort(std::vector<int>& arr, WorkerPool& pool) {
+    return batcherSortWithStats(arr, pool, BATCHER_BITONIC).milliseconds;
+}
+
+inline double oddEvenMergeSort(std::vector<int>& arr, WorkerPool& pool) {
+    return batcherSortWithStats(arr, pool, BATCHER_ODD_EVEN_MERGE).milliseconds;
+}
+
+// Same interface as the other engines' single-argument versions, on a pool
+// of one worker per core created for the call
+inline double bitonicSort(std::vector<int>& arr) {
+    WorkerPool pool;
+    return bitonicSort(arr, pool);
+}
+
+inline double oddEvenMergeSort(std::vector<int>& arr) {
+    WorkerPool pool;
+    return oddEvenMergeSort(arr, pool);
+}
+
+#endif
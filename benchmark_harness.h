@@ -0,0 +1,522 @@
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include "perf_counters.h"
+#include "worker_pool.h"
+
+// ----- Input distributions -----
+
+enum Distribution {
+    DIST_UNIFORM, DIST_SORTED, DIST_REVERSED, DIST_FEW_UNIQUE, DIST_ZIPF, DIST_ORGAN_PIPE, DIST_NEARLY_SORTED
+};
+
+inline const char* distributionName(Distribution dist) {
+    switch (dist) {
+        case DIST_SORTED: return "sorted";
+        case DIST_REVERSED: return "reversed";
+        case DIST_FEW_UNIQUE: return "few-unique";
+        case DIST_ZIPF: return "zipf";
+        case DIST_ORGAN_PIPE: return "organ-pipe";
+        case DIST_NEARLY_SORTED: return "nearly-sorted";
+        default: return "uniform";
+    }
+}
+
+inline std::vector<Distribution> allDistributions() {
+    std::vector<Distribution> dists;
+    for (int d = DIST_UNIFORM; d <= DIST_NEARLY_SORTED; d++) {
+        dists.push_back(static_cast<Distribution>(d));
+    }
+    return dists;
+}
+
+// Array of a given distribution, the same for the same seed:
+// - uniform: keys in [0, INT_MAX]
+// - sorted / reversed: 0..n-1 ascending or descending
+// - few-unique: 16 distinct keys
+// - zipf: rank k (of up to 10^6 ranks) drawn with probability ~ 1 / k
+// - organ-pipe: ascending first half, descending second half
+// - nearly-sorted: sorted, then about 1% of the keys swapped with a partner
+//   at most 8 positions away, like mostly presorted telemetry
+inline std::vector<int> generateDistribution(Distribution dist, long size, unsigned seed) {
+    std::vector<int> arr(size);
+    std::mt19937 gen(seed);
+    switch (dist) {
+        case DIST_SORTED:
+            for (long i = 0; i < size; i++) arr[i] = i;
+            break;
+        case DIST_REVERSED:
+            for (long i = 0; i < size; i++) arr[i] = size - 1 - i;
+            break;
+        case DIST_FEW_UNIQUE: {
+            std::uniform_int_distribution<int> key(0, 15);
+            for (long i = 0; i < size; i++) arr[i] = key(gen) * 1000;
+            break;
+        }
+        case DIST_ZIPF: {
+            long ranks = std::max(1L, std::min(size, 1000000L));
+            std::vector<double> cdf(ranks);
+            double sum = 0;
+            for (long k = 0; k < ranks; k++) {
+                sum += 1.0 / (k + 1);
+                cdf[k] = sum;
+            }
+            std::uniform_real_distribution<double> u(0, sum);
+            for (long i = 0; i < size; i++) {
+                arr[i] = std::lower_bound(cdf.begin(), cdf.end(), u(gen)) - cdf.begin();
+            }
+            break;
+        }
+        case DIST_ORGAN_PIPE:
+            for (long i = 0; i < size; i++) arr[i] = i < size / 2 ? i : size - 1 - i;
+            break;
+        case DIST_NEARLY_SORTED: {
+            for (long i = 0; i < size; i++) arr[i] = i;
+            std::uniform_int_distribution<long> index(0, std::max(size - 1, 0L));
+            std::uniform_int_distribution<long> offset(1, 8);
+            for (long i = 0; i < size / 100; i++) {
+                long from = index(gen);
+                long to = std::min(from + offset(gen), size - 1);
+                std::swap(arr[from], arr[to]);
+            }
+            break;
+        }
+        default: {
+            std::uniform_int_distribution<int> key(0, INT_MAX);
+            for (long i = 0; i < size; i++) arr[i] = key(gen);
+            break;
+        }
+    }
+    return arr;
+}
+
+// ----- Engine registry -----
+
+// Sorts arr in place and returns its own measured time in ms
+typedef std::function<double(std::vector<int>&, WorkerPool&)> EngineFunction;
+
+struct BenchmarkEngine {
+    std::string name;
+    // Largest size the engine is run on (the O(n^2) ones are capped)
+    long maxSize;
+    // Pool engines are run once per thread count of the sweep, the others once
+    bool pooled;
+    EngineFunction sort;
+};
+
+inline std::vector<BenchmarkEngine>& benchmarkEngines() {
+    static std::vector<BenchmarkEngine> engines;
+    return engines;
+}
+
+inline void registerEngine(const std::string& name, long maxSize, bool pooled, const EngineFunction& sort) {
+    BenchmarkEngine engine = {name, maxSize, pooled, sort};
+    benchmarkEngines().push_back(engine);
+}
+
+// ----- Peak RSS -----
+
+// Restarts the peak RSS count of the process (Linux clear_refs); returns
+// false where that is not possible and the peak is the lifetime one
+inline bool resetPeakRss() {
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    return static_cast<bool>(clear.flush());
+}
+
+// Peak resident set size in KB since the last reset
+inline long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return atol(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// ----- Runs and results -----
+
+struct BenchmarkOptions {
+    std::vector<long> sizes;
+    std::vector<Distribution> distributions;
+    std::vector<int> threads;
+    std::vector<std::string> engines;
+    int repetitions;
+    long maxSize;
+    unsigned seed;
+    std::string format;
+    std::string output;
+    // Chrome trace JSON of the whole run (needs a -DSORT_TRACE build)
+    std::string trace;
+    bool adaptive;
+    // Hardware counters per cell, and per round of the instrumented engines
+    bool perf;
+    bool profileRounds;
+    bool selfTest;
+    // Round counts of the transposition and Batcher engines
+    bool roundCounts;
+    // NUMA topology, worker placement and cross-node block exchanges
+    bool numaReport;
+};
+
+struct BenchmarkResult {
+    std::string engine;
+    std::string distribution;
+    long size;
+    // Pool size, 0 for engines that do not run on the pool
+    int threads;
+    int repetitions;
+    double medianMs;
+    double p99Ms;
+    double keysPerSecond;
+    long peakRssKb;
+    bool correct;
+    // Counts per run (warm-up included) when measured with --perf, else -1
+    PerfSample counters;
+};
+
+// Sizes 10 to 10^8, all distributions, pools of 1, 2, 4... threads up to one
+// per core, 5 repetitions, table output
+inline BenchmarkOptions defaultBenchmarkOptions() {
+    BenchmarkOptions options;
+    for (long size = 10; size <= 100000000; size *= 10) {
+        options.sizes.push_back(size);
+    }
+    options.distributions = allDistributions();
+    int cores = WorkerPool::defaultThreadCount();
+    for (int t = 1; t < cores; t *= 2) {
+        options.threads.push_back(t);
+    }
+    options.threads.push_back(cores);
+    options.repetitions = 5;
+    options.maxSize = LONG_MAX;
+    options.seed = 42;
+    options.format = "table";
+    options.adaptive = false;
+    options.perf = false;
+    options.profileRounds = false;
+    options.selfTest = false;
+    options.roundCounts = false;
+    options.numaReport = false;
+    return options;
+}
+
+inline std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Parses --sizes, --dists, --threads, --engines (comma separated lists),
+// --reps, --max-size, --seed, --format table|csv|json, --output file,
+// --trace file and the --adaptive, --perf, --profile, --test, --rounds and --numa switches. Returns false
+// and prints the usage on a bad argument, including an empty list and an
+// unknown distribution name.
+inline bool parseBenchmarkOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--adaptive" || flag == "--perf" || flag == "--profile" || flag == "--test" ||
+            flag == "--rounds" || flag == "--numa") {
+            options.adaptive = options.adaptive || flag == "--adaptive";
+            options.perf = options.perf || flag == "--perf";
+            options.profileRounds = options.profileRounds || flag == "--profile";
+            options.selfTest = options.selfTest || flag == "--test";
+            options.roundCounts = options.roundCounts || flag == "--rounds";
+            options.numaReport = options.numaReport || flag == "--numa";
+            continue;
+        }
+        if (i + 1 >= argc) {
+            flag = "";
+        }
+        std::string value = i + 1 < argc ? argv[++i] : "";
+        bool valid = true;
+        if (flag == "--sizes") {
+            options.sizes.clear();
+            for (const std::string& item : splitList(value)) options.sizes.push_back(atol(item.c_str()));
+            valid = !options.sizes.empty();
+        } else if (flag == "--dists") {
+            options.distributions.clear();
+            for (const std::string& item : splitList(value)) {
+                size_t known = options.distributions.size();
+                for (Distribution dist : allDistributions()) {
+                    if (item == distributionName(dist)) options.distributions.push_back(dist);
+                }
+                valid = valid && options.distributions.size() > known;
+            }
+            valid = valid && !options.distributions.empty();
+        } else if (flag == "--threads") {
+            options.threads.clear();
+            for (const std::string& item : splitList(value)) options.threads.push_back(atoi(item.c_str()));
+            valid = !options.threads.empty();
+        } else if (flag == "--engines") {
+            options.engines = splitList(value);
+            valid = !options.engines.empty();
+        } else if (flag == "--reps") {
+            options.repetitions = std::max(1, atoi(value.c_str()));
+        } else if (flag == "--max-size") {
+            options.maxSize = atol(value.c_str());
+        } else if (flag == "--seed") {
+            options.seed = strtoul(value.c_str(), nullptr, 10);
+        } else if (flag == "--format" && (value == "table" || value == "csv" || value == "json")) {
+            options.format = value;
+        } else if (flag == "--output") {
+            options.output = value;
+        } else if (flag == "--trace") {
+            options.trace = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Usage: " << argv[0] << " [--sizes 10,1000,...] [--dists uniform,sorted,reversed,"
+                      << "few-unique,zipf,organ-pipe,nearly-sorted] [--threads 1,2,4] [--engines name,...]"
+                      << " [--reps 5] [--max-size n] [--seed s] [--format table|csv|json] [--output file]"
+                      << " [--trace file]"
+                      << " [--adaptive] [--perf] [--profile] [--test] [--rounds] [--numa]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nearest-rank percentile of the (sorted) timings
+inline double percentile(const std::vector<double>& sorted, double fraction) {
+    long rank = static_cast<long>(std::ceil(fraction * sorted.size()));
+    return sorted[std::max(0L, std::min<long>(rank, sorted.size()) - 1)];
+}
+
+// One cell: a warm-up run, then the timed repetitions on fresh copies of input
+inline BenchmarkResult runBenchmark(const BenchmarkEngine& engine, Distribution dist, const std::vector<int>& input,
+                                    const std::vector<int>& expected, WorkerPool& pool, int repetitions) {
+    BenchmarkResult result;
+    result.engine = engine.name;
+    result.distribution = distributionName(dist);
+    result.size = input.size();
+    result.threads = engine.pooled ? pool.size() : 0;
+    result.repetitions = repetitions;
+    result.correct = true;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        result.counters.values[e] = -1;
+    }
+
+    resetPeakRss();
+    std::vector<double> times;
+    for (int r = 0; r <= repetitions; r++) {
+        std::vector<int> arr = input;
+        double time = engine.sort(arr, pool);
+        result.correct = result.correct && arr == expected;
+        if (r > 0) {
+            times.push_back(time);
+        }
+    }
+    result.peakRssKb = peakRssKb();
+
+    std::sort(times.begin(), times.end());
+    result.medianMs = percentile(times, 0.5);
+    result.p99Ms = percentile(times, 0.99);
+    result.keysPerSecond = result.medianMs > 0 ? result.size / (result.medianMs / 1000.0) : 0;
+    return result;
+}
+
+inline bool engineSelected(const BenchmarkOptions& options, const BenchmarkEngine& engine) {
+    return options.engines.empty() ||
+           std::find(options.engines.begin(), options.engines.end(), engine.name) != options.engines.end();
+}
+
+// runBenchmark with hardware counters around the whole cell. The counters
+// are inherited, and the cell gets its own pool created after them and
+// joined before the final read, so the pool threads (or the threads an
+// engine spawns itself) are counted as well.
+inline BenchmarkResult runCountedBenchmark(const BenchmarkEngine& engine, Distribution dist,
+                                           const std::vector<int>& input, const std::vector<int>& expected,
+                                           int threads, int repetitions) {
+    PerfCounters counters(true);
+    PerfSample before = counters.read();
+    BenchmarkResult result;
+    {
+        WorkerPool pool(threads);
+        result = runBenchmark(engine, dist, input, expected, pool, repetitions);
+    }
+    PerfSample delta = perfDelta(before, counters.read());
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        result.counters.values[e] = delta.values[e] < 0 ? -1 : delta.values[e] / (repetitions + 1);
+    }
+    return result;
+}
+
+// Every selected engine on every size, distribution and thread count. Pool
+// engines get a fresh pool of each size; the others run once per input.
+inline std::vector<BenchmarkResult> runBenchmarks(const BenchmarkOptions& options) {
+    std::vector<BenchmarkResult> results;
+    for (long size : options.sizes) {
+        if (size > options.maxSize) continue;
+        for (Distribution dist : options.distributions) {
+            std::vector<int> input = generateDistribution(dist, size, options.seed);
+            std::vector<int> expected = input;
+            std::sort(expected.begin(), expected.end());
+
+            for (size_t t = 0; t < options.threads.size(); t++) {
+                // Counted cells build their own pool, inside the counters
+                std::unique_ptr<WorkerPool> pool;
+                if (!options.perf) {
+                    pool.reset(new WorkerPool(options.threads[t]));
+                }
+                for (const BenchmarkEngine& engine : benchmarkEngines()) {
+                    if (!engineSelected(options, engine) || size > engine.maxSize || (!engine.pooled && t > 0)) {
+                        continue;
+                    }
+                    if (options.perf) {
+                        results.push_back(runCountedBenchmark(engine, dist, input, expected, options.threads[t],
+                                                              options.repetitions));
+                    } else {
+                        results.push_back(runBenchmark(engine, dist, input, expected, *pool, options.repetitions));
+                    }
+                    std::cerr << "." << std::flush;
+                }
+            }
+        }
+    }
+    std::cerr << std::endl;
+    return results;
+}
+
+// Every selected engine on small inputs (0 to 100 keys, where the edge cases
+// are) of every distribution, on pools of 1, 2, 3 and 5 threads, checked
+// against std::sort. Quick enough to run under ThreadSanitizer. Prints each
+// failure and a summary and returns the number of failures.
+inline long runSelfTest(const BenchmarkOptions& options) {
+    const long sizes[] = {0, 1, 2, 3, 4, 5, 7, 10, 16, 31, 50, 100};
+    const int threads[] = {1, 2, 3, 5};
+    long checks = 0, failures = 0;
+    for (long size : sizes) {
+        for (Distribution dist : options.distributions) {
+            std::vector<int> input = generateDistribution(dist, size, options.seed + size);
+            std::vector<int> expected = input;
+            std::sort(expected.begin(), expected.end());
+            for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+                WorkerPool pool(threads[t]);
+                for (const BenchmarkEngine& engine : benchmarkEngines()) {
+                    if (!engineSelected(options, engine) || size > engine.maxSize || (!engine.pooled && t > 0)) {
+                        continue;
+                    }
+                    BenchmarkResult result = runBenchmark(engine, dist, input, expected, pool, 1);
+                    checks++;
+                    if (!result.correct) {
+                        failures++;
+                        std::cout << "FAILED " << engine.name << " " << distributionName(dist) << " size " << size
+                                  << " threads " << pool.size() << std::endl;
+                    }
+                }
+            }
+        }
+    }
+    std::cout << checks << " checks, " << failures << " failures" << std::endl;
+    return failures;
+}
+
+// ----- Output -----
+
+inline void writeTable(std::ostream& out, const std::vector<BenchmarkResult>& results, bool counters) {
+    out << std::left << std::setw(24) << "Engine" << std::setw(15) << "Distribution" << std::setw(12) << "Size"
+        << std::setw(9) << "Threads" << std::setw(14) << "Median(ms)" << std::setw(14) << "p99(ms)"
+        << std::setw(16) << "Keys/s" << std::setw(14) << "Peak RSS(KB)" << std::setw(14) << "Verification";
+    for (int e = 0; counters && e < PERF_EVENT_COUNT; e++) {
+        out << std::setw(18) << perfEventName(e);
+    }
+    out << std::endl;
+    out << std::string(counters ? 240 : 130, '-') << std::endl;
+    for (const BenchmarkResult& r : results) {
+        out << std::left << std::setw(24) << r.engine << std::setw(15) << r.distribution << std::setw(12) << r.size
+            << std::setw(9) << (r.threads > 0 ? std::to_string(r.threads) : "-")
+            << std::setw(14) << std::fixed << std::setprecision(3) << r.medianMs << std::setw(14) << r.p99Ms
+            << std::setw(16) << std::setprecision(0) << r.keysPerSecond << std::setw(14) << r.peakRssKb
+            << std::setw(14) << (r.correct ? "Correct" : "Incorrect");
+        for (int e = 0; counters && e < PERF_EVENT_COUNT; e++) {
+            out << std::setw(18) << (r.counters.values[e] < 0 ? "n/a" : std::to_string(r.counters.values[e]));
+        }
+        out << std::endl;
+    }
+}
+
+inline void writeCsv(std::ostream& out, const std::vector<BenchmarkResult>& results, bool counters) {
+    out << "engine,distribution,size,threads,repetitions,median_ms,p99_ms,keys_per_second,peak_rss_kb,correct";
+    for (int e = 0; counters && e < PERF_EVENT_COUNT; e++) {
+        out << "," << perfEventName(e);
+    }
+    out << std::endl;
+    for (const BenchmarkResult& r : results) {
+        out << r.engine << "," << r.distribution << "," << r.size << ","
+            << (r.threads > 0 ? std::to_string(r.threads) : "") << "," << r.repetitions << ","
+            << std::fixed << std::setprecision(6) << r.medianMs << "," << r.p99Ms << ","
+            << std::setprecision(0) << r.keysPerSecond << "," << r.peakRssKb << ","
+            << (r.correct ? "true" : "false");
+        for (int e = 0; counters && e < PERF_EVENT_COUNT; e++) {
+            out << "," << (r.counters.values[e] < 0 ? "" : std::to_string(r.counters.values[e]));
+        }
+        out << std::endl;
+    }
+}
+
+inline void writeJson(std::ostream& out, const std::vector<BenchmarkResult>& results, bool counters) {
+    out << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        out << "  {\"engine\": \"" << r.engine << "\", \"distribution\": \"" << r.distribution
+            << "\", \"size\": " << r.size << ", \"threads\": "
+            << (r.threads > 0 ? std::to_string(r.threads) : "null") << ", \"repetitions\": " << r.repetitions
+            << ", \"median_ms\": " << std::fixed << std::setprecision(6) << r.medianMs
+            << ", \"p99_ms\": " << r.p99Ms << ", \"keys_per_second\": " << std::setprecision(0) << r.keysPerSecond
+            << ", \"peak_rss_kb\": " << r.peakRssKb << ", \"correct\": " << (r.correct ? "true" : "false");
+        for (int e = 0; counters && e < PERF_EVENT_COUNT; e++) {
+            out << ", \"" << perfEventName(e) << "\": "
+                << (r.counters.values[e] < 0 ? "null" : std::to_string(r.counters.values[e]));
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+// Writes the results in the chosen format to the output file or stdout
+inline bool writeResults(const BenchmarkOptions& options, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output.c_str());
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return false;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "csv") {
+        writeCsv(out, results, options.perf);
+    } else if (options.format == "json") {
+        writeJson(out, results, options.perf);
+    } else {
+        writeTable(out, results, options.perf);
+    }
+    return true;
+}
+
+#endif
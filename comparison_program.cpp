@@ -6,24 +6,20 @@
 #include <random>
 #include <iomanip>
 #include <climits>
-#include <mutex>
 #include <memory>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+#include "odd_even_transposition_sort.h"
+#include "sasaki_time_optimal_sort.h"
+#include "alternative_time_optimal_sort.h"
+#include "hybrid_sort.h"
+#include "batcher_sort.h"
+#include "mesh_sort.h"
+#include "temporal_blocking.h"
+#include "benchmark_harness.h"
 using namespace std;
 
-// Generate random array for testing
-vector<int> generateRandomArray(int size) {
-    vector<int> arr(size);
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> distrib(1, 1000);
-    
-    for (int i = 0; i < size; i++) {
-        arr[i] = distrib(gen);
-    }
-    
-    return arr;
-}
-
 // Verify if array is sorted
 bool isSorted(const vector<int>& arr) {
     for (int i = 1; i < arr.size(); i++) {
@@ -32,35 +28,28 @@ bool isSorted(const vector<int>& arr) {
     return true;
 }
 
-// Quick way to display an array
-void printArray(const vector<int>& arr) {
-    for (int val : arr) {
-        cout << val << " ";
-    }
-    cout << endl;
-}
-
 // ----- Odd-Even Transposition Sort Algorithm -----
+// The comparators of a phase own disjoint pairs, so they need no lock; the
+// join at the end of the round orders one phase before the next
 struct OEArguments {
     vector<int>& arr;
     int n;
     int index;
-    mutex& mtx;
     
-    OEArguments(vector<int>& a, int size, int idx, mutex& m) 
-        : arr(a), n(size), index(idx), mtx(m) {}
+    OEArguments(vector<int>& a, int size, int idx) 
+        : arr(a), n(size), index(idx) {}
 };
 
 void oeCompare(OEArguments args) {
+    SORT_TRACE_BEGIN("compare", -1);
     int index = args.index;
     
-    // Use mutex to protect the comparison and swap operation
-    lock_guard<mutex> lock(args.mtx);
     if ((index + 1 < args.n) && (args.arr[index + 1] < args.arr[index])) {
         int temp = args.arr[index];
         args.arr[index] = args.arr[index + 1];
         args.arr[index + 1] = temp;
     }
+    SORT_TRACE_END("compare", -1);
 }
 
 double oddEvenTranspositionSort(vector<int>& arr) {
@@ -68,17 +57,18 @@ double oddEvenTranspositionSort(vector<int>& arr) {
     
     int n = arr.size();
     int max_threads = (n + 1) / 2;
-    mutex mtx;
     
     // For n rounds
     for (int i = 1; i <= n; i++) {
+        SORT_TRACE_BEGIN("round", i);
+        SORT_TRACE_BEGIN("spawn", i);
         vector<thread> threads;
         
         // Odd exchanges
         if (i % 2 == 1) {
             for (int j = 0, index = 0; j < max_threads; j++, index += 2) {
                 if (index + 1 >= n) continue; // Skip if out of bounds
-                OEArguments args(arr, n, index, mtx);
+                OEArguments args(arr, n, index);
                 threads.push_back(thread(oeCompare, args));
             }
         }
@@ -86,15 +76,20 @@ double oddEvenTranspositionSort(vector<int>& arr) {
         else {
             for (int j = 0, index = 1; j < max_threads - 1; j++, index += 2) {
                 if (index + 1 >= n) continue; // Skip if out of bounds
-                OEArguments args(arr, n, index, mtx);
+                OEArguments args(arr, n, index);
                 threads.push_back(thread(oeCompare, args));
             }
         }
         
+        SORT_TRACE_END("spawn", i);
+
         // Join all threads
+        SORT_TRACE_BEGIN("join", i);
         for (auto& thread : threads) {
             thread.join();
         }
+        SORT_TRACE_END("join", i);
+        SORT_TRACE_END("round", i);
     }
     
     auto end = chrono::high_resolution_clock::now();
@@ -113,16 +108,17 @@ struct Node {
     int area;
     Node *left;
     Node *right;
+    // Neighbour elements copied in the read phase of a round
+    Element fromLeft, fromRight;
     
-    Node() : left(nullptr), right(nullptr), area(0) {}
+    Node() : area(0), left(nullptr), right(nullptr) {}
     ~Node() = default; // Let unique_ptr handle cleanup
 };
 
 struct SArguments {
     Node *node;
-    mutex& mtx;
     
-    SArguments(Node* n, mutex& m) : node(n), mtx(m) {}
+    SArguments(Node* n) : node(n) {}
 };
 
 vector<int> getSortedList(Node *root, size_t size) {
@@ -142,65 +138,49 @@ vector<int> getSortedList(Node *root, size_t size) {
     return result;
 }
 
-void sasakiCompare(SArguments args) {
-    lock_guard<mutex> lock(args.mtx);
-    
-    if (args.node->left != nullptr) {
-        if (args.node->left->rValue->value > args.node->lValue->value) {
-            if (args.node->left->rValue->isMarked == true) {
-                args.node->area--;
-            }
-            if (args.node->lValue->isMarked == true) {
-                args.node->area++;
-            }
-            
-            // Swap Elements safely using C++11 compatible code
-            unique_ptr<Element> tempElement(new Element());
-            tempElement->value = args.node->left->rValue->value;
-            tempElement->isMarked = args.node->left->rValue->isMarked;
-            
-            args.node->left->rValue->value = args.node->lValue->value;
-            args.node->left->rValue->isMarked = args.node->lValue->isMarked;
-            
-            args.node->lValue->value = tempElement->value;
-            args.node->lValue->isMarked = tempElement->isMarked;
-        }
+// Read phase: copy the boundary elements of both neighbours. Nothing is
+// written during this phase, so the reads need no lock.
+void sasakiRead(SArguments args) {
+    SORT_TRACE_BEGIN("read", -1);
+    Node* node = args.node;
+    if (node->left != nullptr) {
+        node->fromLeft = *node->left->rValue;
     }
-    
-    if (args.node->right != nullptr) {
-        if (args.node->right->lValue->value < args.node->rValue->value) {
-            if (args.node->right->lValue->isMarked == true) {
-                args.node->right->area++;
-            }
-            if (args.node->rValue->isMarked == true) {
-                args.node->right->area--;
-            }
-            
-            // Swap Elements safely using C++11 compatible code
-            unique_ptr<Element> tempElement(new Element());
-            tempElement->value = args.node->right->lValue->value;
-            tempElement->isMarked = args.node->right->lValue->isMarked;
-            
-            args.node->right->lValue->value = args.node->rValue->value;
-            args.node->right->lValue->isMarked = args.node->rValue->isMarked;
-            
-            args.node->rValue->value = tempElement->value;
-            args.node->rValue->isMarked = tempElement->isMarked;
+    if (node->right != nullptr) {
+        node->fromRight = *node->right->lValue;
+    }
+    SORT_TRACE_END("read", -1);
+}
+
+// Commit phase: every node updates only its own elements and area from the
+// copies. Both sides of a boundary see the same pair, so they agree on the
+// swap without talking to each other.
+void sasakiCommit(SArguments args) {
+    SORT_TRACE_BEGIN("commit", -1);
+    Node* node = args.node;
+    if (node->left != nullptr && node->fromLeft.value > node->lValue->value) {
+        // if marked element moves left, increase the area
+        // if marked element moves right, decrease the area
+        if (node->fromLeft.isMarked == true) {
+            node->area--;
         }
+        if (node->lValue->isMarked == true) {
+            node->area++;
+        }
+        *node->lValue = node->fromLeft;
     }
-    
-    if (args.node->lValue->value > args.node->rValue->value) {
-        // Swap Elements safely using C++11 compatible code
-        unique_ptr<Element> tempElement(new Element());
-        tempElement->value = args.node->lValue->value;
-        tempElement->isMarked = args.node->lValue->isMarked;
-        
-        args.node->lValue->value = args.node->rValue->value;
-        args.node->lValue->isMarked = args.node->rValue->isMarked;
-        
-        args.node->rValue->value = tempElement->value;
-        args.node->rValue->isMarked = tempElement->isMarked;
+
+    if (node->right != nullptr && node->fromRight.value < node->rValue->value) {
+        *node->rValue = node->fromRight;
     }
+
+    if (node->lValue->value > node->rValue->value) {
+        // Swap the Elements by value, no heap allocation per swap
+        Element tempElement = *node->lValue;
+        *node->lValue = *node->rValue;
+        *node->rValue = tempElement;
+    }
+    SORT_TRACE_END("commit", -1);
 }
 
 double sasakiTimeOptimalSort(vector<int>& arr, vector<int>& result) {
@@ -211,7 +191,6 @@ double sasakiTimeOptimalSort(vector<int>& arr, vector<int>& result) {
     nodeList.reserve(n);
     
     Node *prev = nullptr, *root = nullptr;
-    mutex mtx;
     
     // Initialization of process nodes in the linked list
     for (int i = 0; i < n; i++) {
@@ -242,10 +221,10 @@ double sasakiTimeOptimalSort(vector<int>& arr, vector<int>& result) {
             
             node->area = 0;
         } else {
-            // Middle nodes
+            // Middle nodes: two unmarked copies
             node->lValue.reset(new Element());
             node->lValue->value = arr[i];
-            node->lValue->isMarked = true;
+            node->lValue->isMarked = false;
             
             node->rValue.reset(new Element());
             node->rValue->value = arr[i];
@@ -265,21 +244,30 @@ double sasakiTimeOptimalSort(vector<int>& arr, vector<int>& result) {
         nodeList.push_back(move(uniqueNode));
     }
     
-    // For n - 1 rounds
+    // For n - 1 rounds, each a read phase and a commit phase
     for (int i = 1; i < n; i++) {
-        vector<thread> threads;
-        Node *temp = root;
-        
-        for (int j = 0; j < n && temp != nullptr; j++) {
-            SArguments args(temp, mtx);
-            threads.push_back(thread(sasakiCompare, args));
-            temp = temp->right;
-        }
-        
-        // Join all threads
-        for (auto& thread : threads) {
-            thread.join();
+        SORT_TRACE_BEGIN("round", i);
+        for (auto phase : {sasakiRead, sasakiCommit}) {
+            SORT_TRACE_BEGIN("spawn", i);
+            vector<thread> threads;
+            Node *temp = root;
+            
+            for (int j = 0; j < n && temp != nullptr; j++) {
+                SArguments args(temp);
+                threads.push_back(thread(phase, args));
+                temp = temp->right;
+            }
+            
+            SORT_TRACE_END("spawn", i);
+
+            // Join all threads before the next phase
+            SORT_TRACE_BEGIN("join", i);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            SORT_TRACE_END("join", i);
         }
+        SORT_TRACE_END("round", i);
     }
     
     // Get sorted result
@@ -293,14 +281,15 @@ double sasakiTimeOptimalSort(vector<int>& arr, vector<int>& result) {
 }
 
 // ----- Alternate Time Optimal Sort Algorithm -----
+// Centers of a round are 3 apart, so their triplets are disjoint and need
+// no lock
 struct AArguments {
     vector<int>& arr;
     int n;
     int center;
-    mutex& mtx;
     
-    AArguments(vector<int>& a, int size, int c, mutex& m) 
-        : arr(a), n(size), center(c), mtx(m) {}
+    AArguments(vector<int>& a, int size, int c) 
+        : arr(a), n(size), center(c) {}
 };
 
 void swap(vector<int>& arr, int i, int j) {
@@ -310,7 +299,7 @@ void swap(vector<int>& arr, int i, int j) {
 }
 
 void alternateCompare(AArguments args) {
-    lock_guard<mutex> lock(args.mtx);
+    SORT_TRACE_BEGIN("compare", -1);
     
     // edge case
     if (args.center - 1 < 0) {
@@ -325,23 +314,21 @@ void alternateCompare(AArguments args) {
     }
     // non - edge case
     else {
-        int minValue = min({args.arr[args.center], args.arr[args.center - 1], args.arr[args.center + 1]});
-        int maxValue = max({args.arr[args.center], args.arr[args.center - 1], args.arr[args.center + 1]});
-        int midValue = args.arr[args.center] + args.arr[args.center - 1] + args.arr[args.center + 1] - minValue - maxValue;
-        args.arr[args.center - 1] = minValue;
-        args.arr[args.center + 1] = maxValue;
-        args.arr[args.center] = midValue;
+        // The mid comes from min and max only, so large values cannot overflow
+        sortTriplet(args.arr.data(), args.n, args.center);
     }
+    SORT_TRACE_END("compare", -1);
 }
 
 double alternateTimeOptimalSorting(vector<int>& arr) {
     auto start = chrono::high_resolution_clock::now();
     
     int n = arr.size();
-    mutex mtx;
     
     // For n - 1 rounds
     for (int i = 1; i < n; i++) {
+        SORT_TRACE_BEGIN("round", i);
+        SORT_TRACE_BEGIN("spawn", i);
         int remainder = (i + 1) % 3;
         int j;
         if (remainder == 0) {
@@ -358,16 +345,21 @@ double alternateTimeOptimalSorting(vector<int>& arr) {
         
         // For all centers possible at a distance of 3
         while (j < n) {
-            AArguments args(arr, n, j, mtx);
+            AArguments args(arr, n, j);
             threads.push_back(thread(alternateCompare, args));
             // Incrementing by 3 to find the next center
             j += 3;
         }
         
+        SORT_TRACE_END("spawn", i);
+
         // Join all threads
+        SORT_TRACE_BEGIN("join", i);
         for (auto& thread : threads) {
             thread.join();
         }
+        SORT_TRACE_END("join", i);
+        SORT_TRACE_END("round", i);
     }
     
     auto end = chrono::high_resolution_clock::now();
@@ -375,60 +367,297 @@ double alternateTimeOptimalSorting(vector<int>& arr) {
     return duration.count();
 }
 
-// ----- Main Comparison Function -----
-int main() {
-    vector<int> sizes = {10, 20, 30, 50};
-    
-    cout << "==== Comparison of Distributed Sorting Algorithms ====" << endl << endl;
-    
-    cout << left << setw(10) << "Size" 
-         << setw(25) << "Odd-Even (ms)" 
-         << setw(25) << "Sasaki (ms)" 
-         << setw(25) << "Alternative (ms)" << endl;
-    
-    cout << string(85, '-') << endl;
-    
+// ----- Adaptive Comparison -----
+// Early termination on mostly presorted input: rounds executed out of the
+// fixed bound, exchanges made and time for each engine
+void runAdaptiveComparison(WorkerPool& pool) {
+    vector<int> sizes = {1000, 10000, 100000, 1000000};
+
+    cout << endl << "==== Adaptive Mode, Nearly Sorted Input (rounds / swaps / ms) ====" << endl << endl;
+    cout << left << setw(10) << "Size"
+         << setw(30) << "Odd-Even"
+         << setw(30) << "Sasaki SoA"
+         << setw(30) << "Alternative" << endl;
+
+    cout << string(100, '-') << endl;
+
     for (int size : sizes) {
-        // Generate the same random array for all algorithms
-        vector<int> arr = generateRandomArray(size);
-        
-        // Print the random array
-        cout << "Random Array (Size " << size << "):" << endl;
-        printArray(arr);
-        cout << endl;
-        
-        // Test Odd-Even Transposition Sort
+        vector<int> arr = generateDistribution(DIST_NEARLY_SORTED, size, random_device{}());
+
         vector<int> arr1 = arr;
-        double time1 = oddEvenTranspositionSort(arr1);
-        bool sorted1 = isSorted(arr1);
-        
-        // Test Sasaki's Time Optimal Sort
+        SortStats stats1 = oddEvenTranspositionSortWithStats(arr1, pool, true);
+
         vector<int> arr2 = arr;
         vector<int> result2;
-        double time2 = sasakiTimeOptimalSort(arr2, result2);
-        bool sorted2 = isSorted(result2);
-        
-        // Test Alternative Time Optimal Sort
+        SortStats stats2 = sasakiArenaTimeOptimalSortWithStats(arr2, result2, pool, true);
+
         vector<int> arr3 = arr;
-        double time3 = alternateTimeOptimalSorting(arr3);
-        bool sorted3 = isSorted(arr3);
-        
-        cout << left << setw(10) << size 
-             << setw(25) << fixed << setprecision(3) << time1 
-             << setw(25) << time2 
-             << setw(25) << time3  << endl;
+        SortStats stats3 = alternateTimeOptimalSortingWithStats(arr3, pool, true);
+
+        bool sorted = isSorted(arr1) && isSorted(result2) && isSorted(arr3);
+        cout << left << setw(10) << size;
+        for (const SortStats& stats : {stats1, stats2, stats3}) {
+            ostringstream cell;
+            cell << stats.rounds << " / " << stats.swaps << " / " << fixed << setprecision(3) << stats.milliseconds;
+            cout << setw(30) << cell.str();
+        }
+        cout << (sorted ? "" : "Incorrect") << endl;
     }
-    
-    // Analysis
-    cout << endl << "==== Analysis ====" << endl;
-    cout << "1. Odd-Even Transposition Sort: O(n) time complexity, requires n rounds." << endl;
-    cout << "2. Sasaki's Time Optimal Sort: O(n) time complexity with optimized communication, requires n-1 rounds." << endl;
-    cout << "3. Alternative Time Optimal Sort: O(n) time complexity using local neighborhood operations." << endl;
-    
-    cout << endl << "The time-optimal algorithms (Sasaki's and Alternative) aim to reduce the" << endl;
-    cout << "total number of communication rounds required compared to the basic Odd-Even sort." << endl;
-    cout << "Sasaki's algorithm uses a more complex node structure and area marking strategy," << endl;
-    cout << "while the Alternative algorithm uses triplet-based comparisons in a modulo-3 pattern." << endl;
-    
-    return 0;
-}
\ No newline at end of file
+}
+
+// ----- Round Counts -----
+// Rounds of the transposition engines (n for Odd-Even, n - 1 for Sasaki and
+// Alternate) next to the rounds and time of the two Batcher networks and
+// the mesh steps and time of Shearsort
+void runRoundCounts(WorkerPool& pool) {
+    vector<int> sizes = {1000, 10000, 100000, 1000000};
+
+    cout << endl << "==== Rounds, Uniform Input (rounds / ms for Batcher and Shearsort) ====" << endl << endl;
+    cout << left << setw(10) << "Size"
+         << setw(16) << "Odd-Even"
+         << setw(16) << "Alternative"
+         << setw(24) << "Bitonic"
+         << setw(24) << "Odd-Even Merge"
+         << setw(24) << "Shearsort" << endl;
+
+    cout << string(114, '-') << endl;
+
+    for (int size : sizes) {
+        vector<int> arr = generateDistribution(DIST_UNIFORM, size, random_device{}());
+
+        vector<int> arr1 = arr;
+        SortStats stats1 = batcherSortWithStats(arr1, pool, BATCHER_BITONIC);
+
+        vector<int> arr2 = arr;
+        SortStats stats2 = batcherSortWithStats(arr2, pool, BATCHER_ODD_EVEN_MERGE);
+
+        vector<int> arr3 = arr;
+        SortStats stats3 = shearSortWithStats(arr3, pool);
+
+        bool sorted = isSorted(arr1) && isSorted(arr2) && isSorted(arr3);
+        cout << left << setw(10) << size << setw(16) << size << setw(16) << size - 1;
+        for (const SortStats& stats : {stats1, stats2, stats3}) {
+            ostringstream cell;
+            cell << stats.rounds << " / " << fixed << setprecision(3) << stats.milliseconds;
+            cout << setw(24) << cell.str();
+        }
+        cout << (sorted ? "" : "Incorrect") << endl;
+    }
+}
+
+// ----- NUMA Placement -----
+// Nodes and CPUs found under /sys, the core and node every worker is pinned
+// to, and for the two block engines how many neighbour merge-splits crossed
+// a node boundary and how many keys they read from the other socket
+void runNumaReport(WorkerPool& pool) {
+    const NumaTopology& topology = numaTopology();
+    cout << endl << "==== NUMA Topology ====" << endl << endl;
+    for (int node = 0; node < topology.nodes(); node++) {
+        cout << "Node " << topology.kernelIds[node] << ": " << topology.nodeCpus[node].size() << " CPUs (";
+        for (size_t k = 0; k < topology.nodeCpus[node].size(); k++) {
+            cout << (k > 0 ? "," : "") << topology.nodeCpus[node][k];
+        }
+        cout << ")" << endl;
+    }
+    cout << endl << "Workers (core/node):";
+    for (int w = 0; w < pool.size(); w++) {
+        cout << " " << w << ":" << pool.core(w) << "/" << topology.kernelIds[pool.node(w)];
+    }
+    cout << endl;
+
+    vector<int> sizes = {1000000, 10000000};
+    cout << endl << "==== Block Exchanges Across Nodes, Uniform Input (" << pool.size() << " threads) ===="
+         << endl << endl;
+    cout << left << setw(16) << "Engine" << setw(12) << "Size" << setw(12) << "Time(ms)" << setw(12) << "Exchanges"
+         << setw(14) << "Cross-node" << setw(20) << "Cross-node keys" << "Verification" << endl;
+    cout << string(98, '-') << endl;
+
+    for (int size : sizes) {
+        vector<int> arr = generateDistribution(DIST_UNIFORM, size, random_device{}());
+        for (const string& engine : {string("block-odd-even"), string("block-sasaki")}) {
+            vector<int> data = arr;
+            CrossNodeCounter counter;
+            double time;
+            if (engine == "block-odd-even") {
+                time = blockOddEvenTranspositionSort(data, pool, &counter);
+            } else {
+                vector<int> result;
+                time = blockSasakiTimeOptimalSort(data, result, pool, &counter);
+                data.swap(result);
+            }
+            cout << left << setw(16) << engine << setw(12) << size << setw(12) << fixed << setprecision(3) << time
+                 << setw(12) << counter.exchanges() << setw(14) << counter.crossNodeExchanges()
+                 << setw(20) << counter.crossNodeKeys() << (isSorted(data) ? "Correct" : "Incorrect") << endl;
+        }
+    }
+}
+
+// ----- Engine Registration -----
+// Every engine the harness can run. The thread-per-comparison versions and
+// the O(n^2) pool engines are capped at sizes they finish in reasonable time.
+void registerComparisonEngines() {
+    registerEngine("std::sort", 100000000, false, [](vector<int>& arr, WorkerPool&) {
+        auto start = chrono::high_resolution_clock::now();
+        sort(arr.begin(), arr.end());
+        chrono::duration<double, milli> duration = chrono::high_resolution_clock::now() - start;
+        return duration.count();
+    });
+    registerEngine("odd-even-threads", 100, false, [](vector<int>& arr, WorkerPool&) {
+        return oddEvenTranspositionSort(arr);
+    });
+    registerEngine("sasaki-threads", 100, false, [](vector<int>& arr, WorkerPool&) {
+        vector<int> result;
+        double time = sasakiTimeOptimalSort(arr, result);
+        arr.swap(result);
+        return time;
+    });
+    registerEngine("alternate-threads", 100, false, [](vector<int>& arr, WorkerPool&) {
+        return alternateTimeOptimalSorting(arr);
+    });
+    registerEngine("odd-even", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return oddEvenTranspositionSort(arr, pool);
+    });
+    registerEngine("odd-even-simd", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return simdOddEvenTranspositionSort(arr, pool);
+    });
+    registerEngine("odd-even-wavefront", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return wavefrontOddEvenTranspositionSort(arr, pool);
+    });
+    registerEngine("odd-even-temporal", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return temporalOddEvenTranspositionSort(arr, pool);
+    });
+    registerEngine("sasaki", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        vector<int> result;
+        double time = sasakiTimeOptimalSort(arr, result, pool);
+        arr.swap(result);
+        return time;
+    });
+    registerEngine("sasaki-soa", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        vector<int> result;
+        double time = sasakiArenaTimeOptimalSort(arr, result, pool);
+        arr.swap(result);
+        return time;
+    });
+    registerEngine("sasaki-wavefront", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        vector<int> result;
+        double time = wavefrontSasakiTimeOptimalSort(arr, result, pool);
+        arr.swap(result);
+        return time;
+    });
+    registerEngine("alternate", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return alternateTimeOptimalSorting(arr, pool);
+    });
+    registerEngine("alternate-simd", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return simdAlternateTimeOptimalSorting(arr, pool);
+    });
+    registerEngine("alternate-wavefront", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return wavefrontAlternateTimeOptimalSorting(arr, pool);
+    });
+    registerEngine("alternate-temporal", 100000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return temporalAlternateTimeOptimalSorting(arr, pool);
+    });
+    registerEngine("block-odd-even", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return blockOddEvenTranspositionSort(arr, pool);
+    });
+    registerEngine("block-sasaki", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        vector<int> result;
+        double time = blockSasakiTimeOptimalSort(arr, result, pool);
+        arr.swap(result);
+        return time;
+    });
+    registerEngine("hybrid-odd-even", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return hybridSort(arr, pool, TILE_ODD_EVEN);
+    });
+    registerEngine("hybrid-alternate", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return hybridSort(arr, pool, TILE_ALTERNATE);
+    });
+    registerEngine("bitonic", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return bitonicSort(arr, pool);
+    });
+    registerEngine("odd-even-merge", 100000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return oddEvenMergeSort(arr, pool);
+    });
+    registerEngine("shearsort", 1000000, true, [](vector<int>& arr, WorkerPool& pool) {
+        return shearSort(arr, pool);
+    });
+}
+
+// ----- Round Profile -----
+// Hardware counters per round and worker of the three pool engines, on the
+// first selected size and distribution with the largest thread count, as CSV
+bool runRoundProfile(const BenchmarkOptions& options) {
+    WorkerPool pool(options.threads.back());
+    vector<int> arr = generateDistribution(options.distributions[0], options.sizes[0], options.seed);
+
+    ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output.c_str());
+    }
+    ostream& out = options.output.empty() ? cout : file;
+    RoundProfiler::writeCsvHeader(out);
+
+    RoundProfiler profiler;
+    vector<int> arr1 = arr;
+    oddEvenTranspositionSortWithStats(arr1, pool, false, &profiler);
+    profiler.writeCsv(out, "odd-even");
+
+    vector<int> arr2 = arr;
+    vector<int> result2;
+    sasakiArenaTimeOptimalSortWithStats(arr2, result2, pool, false, &profiler);
+    profiler.writeCsv(out, "sasaki-soa");
+
+    vector<int> arr3 = arr;
+    alternateTimeOptimalSortingWithStats(arr3, pool, false, &profiler);
+    profiler.writeCsv(out, "alternate");
+
+    if (!profiler.available()) {
+        cerr << "No hardware counters available (see /proc/sys/kernel/perf_event_paranoid)" << endl;
+    }
+    return isSorted(arr1) && isSorted(result2) && isSorted(arr3);
+}
+
+// ----- Main Comparison Function -----
+// Runs the benchmark harness over every registered engine; see
+// parseBenchmarkOptions for the arguments. --adaptive prints the early
+// termination report instead, --profile the per-round counters, --rounds
+// the round counts of the Batcher engines, --numa the NUMA placement report and --test runs the self-test (build with -fsanitize=thread to check for races).
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options = defaultBenchmarkOptions();
+    if (!parseBenchmarkOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    if (options.adaptive) {
+        WorkerPool pool(options.threads.back());
+        runAdaptiveComparison(pool);
+        return 0;
+    }
+    if (options.profileRounds) {
+        return runRoundProfile(options) ? 0 : 1;
+    }
+    if (options.roundCounts) {
+        WorkerPool pool(options.threads.back());
+        runRoundCounts(pool);
+        return 0;
+    }
+    if (options.numaReport) {
+        WorkerPool pool(options.threads.back());
+        runNumaReport(pool);
+        return 0;
+    }
+    if (options.selfTest) {
+        registerComparisonEngines();
+        return runSelfTest(options) == 0 ? 0 : 1;
+    }
+
+    registerComparisonEngines();
+    vector<BenchmarkResult> results = runBenchmarks(options);
+    if (!options.trace.empty()) {
+        if (!traceCompiledIn()) {
+            cerr << "Tracing is compiled out, rebuild with -DSORT_TRACE" << endl;
+        } else if (!writeTrace(options.trace)) {
+            cerr << "Cannot write " << options.trace << endl;
+        }
+    }
+    return writeResults(options, results) ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include "discrete_event_simulator.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+void printRow(const string& algorithm, int size, const SimReport& report, bool correct) {
+    cout << left << setw(12) << algorithm << setw(10) << size
+         << setw(18) << fixed << setprecision(1) << report.simulatedTime
+         << setw(14) << report.messages << setw(14) << report.bytes
+         << (correct ? "Correct" : "Incorrect") << endl;
+}
+
+// Arguments: link latency (default 1), link bandwidth in bytes per time unit
+// (default 4), largest array size (default 1000)
+int main(int argc, char* argv[]) {
+    LinkModel link;
+    link.latency = argc > 1 ? atof(argv[1]) : 1.0;
+    link.bandwidth = argc > 2 ? atof(argv[2]) : 4.0;
+    int largest = argc > 3 ? atoi(argv[3]) : 1000;
+
+    vector<int> sizes;
+    for (int size = 10; size <= largest; size *= 10) {
+        sizes.push_back(size);
+    }
+
+    cout << "=== Linear Array Simulation (latency " << link.latency
+         << ", bandwidth " << link.bandwidth << " bytes per time unit) ===" << endl << endl;
+    cout << left << setw(12) << "Algorithm" << setw(10) << "Size" << setw(18) << "Simulated time"
+         << setw(14) << "Messages" << setw(14) << "Bytes" << "Verification" << endl;
+    cout << string(80, '-') << endl;
+
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> expected = arr;
+        sort(expected.begin(), expected.end());
+
+        vector<int> oddEven = arr;
+        SimReport report = simulateOddEvenTranspositionSort(oddEven, link);
+        printRow("Odd-Even", size, report, oddEven == expected);
+
+        vector<int> sasaki;
+        report = simulateSasakiTimeOptimalSort(arr, sasaki, link);
+        printRow("Sasaki", size, report, sasaki == expected);
+
+        vector<int> alternate = arr;
+        report = simulateAlternateTimeOptimalSorting(alternate, link);
+        printRow("Alternate", size, report, alternate == expected);
+    }
+
+    return 0;
+}
@@ -0,0 +1,371 @@
+#ifndef DISCRETE_EVENT_SIMULATOR_H
+#define DISCRETE_EVENT_SIMULATOR_H
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "alternative_time_optimal_sort.h"
+
+// Message between two neighbouring processes of the linear array
+struct Message {
+    int source;
+    long round;
+    int value;
+    bool marked;
+    int bytes;
+};
+
+// Cost of one directed link: a message of b bytes occupies the link for
+// b / bandwidth time units and arrives latency time units after that
+struct LinkModel {
+    double latency;
+    double bandwidth;
+};
+
+// What a simulated run cost
+struct SimReport {
+    double simulatedTime;
+    long messages;
+    long bytes;
+};
+
+class Simulator;
+
+// A process of the linear array. Delivered messages wait in its mailbox
+// until the process asks for them; after every delivery receive() runs, so a
+// process is a small state machine that advances as far as its mailbox allows.
+// Processes are plain objects driven by one event loop, which keeps a million
+// of them cheap (no stack or OS thread per process).
+class SimProcess {
+public:
+    virtual ~SimProcess() {}
+    virtual void start(Simulator& sim) = 0;
+    virtual void receive(Simulator& sim) = 0;
+
+    bool has(int source, long round) const {
+        for (const Message& msg : mailbox) {
+            if (msg.source == source && msg.round == round) return true;
+        }
+        return false;
+    }
+
+    // Removes the message of a round from a source, which must have arrived
+    Message take(int source, long round) {
+        for (size_t i = 0; i < mailbox.size(); i++) {
+            if (mailbox[i].source == source && mailbox[i].round == round) {
+                Message msg = mailbox[i];
+                mailbox.erase(mailbox.begin() + i);
+                return msg;
+            }
+        }
+        return Message();
+    }
+
+    std::vector<Message> mailbox;
+};
+
+// Event loop of the simulator. The only events are message deliveries, kept
+// in time order (ties in send order); each directed neighbour link serialises
+// its messages, so a link is a FIFO with latency and bandwidth.
+class Simulator {
+public:
+    Simulator(std::vector<SimProcess*>& processes, const LinkModel& link)
+        : processes(processes), link(link), linkFree(2 * processes.size(), 0.0),
+          clock(0), sequence(0), messages(0), bytes(0) {}
+
+    double now() const { return clock; }
+
+    // Sends msg from one process to its left or right neighbour
+    void send(int from, int to, const Message& msg) {
+        double& free = linkFree[2 * from + (to > from ? 1 : 0)];
+        double start = std::max(clock, free);
+        free = start + msg.bytes / link.bandwidth;
+        Event event = {free + link.latency, sequence++, to, msg};
+        events.push(event);
+        messages++;
+        bytes += msg.bytes;
+    }
+
+    SimReport run() {
+        for (SimProcess* process : processes) {
+            process->start(*this);
+        }
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            clock = event.time;
+            processes[event.target]->mailbox.push_back(event.msg);
+            processes[event.target]->receive(*this);
+        }
+        SimReport report = {clock, messages, bytes};
+        return report;
+    }
+
+private:
+    struct Event {
+        double time;
+        long sequence;
+        int target;
+        Message msg;
+
+        bool operator>(const Event& other) const {
+            return time > other.time || (time == other.time && sequence > other.sequence);
+        }
+    };
+
+    std::vector<SimProcess*>& processes;
+    LinkModel link;
+    std::vector<double> linkFree;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event> > events;
+    double clock;
+    long sequence;
+    long messages;
+    long bytes;
+};
+
+// ----- Odd-Even Transposition Sort -----
+// Process id holds one value. In round i it exchanges values with its
+// partner of that phase, if it has one, and keeps the min (left) or max
+// (right); without a partner it moves straight on to the next round.
+class OddEvenProcess : public SimProcess {
+public:
+    OddEvenProcess(int id, int n, int value) : value(value), id(id), n(n), round(1), sent(false) {}
+
+    void start(Simulator& sim) { advance(sim); }
+    void receive(Simulator& sim) { advance(sim); }
+
+    int value;
+
+private:
+    void advance(Simulator& sim) {
+        // For n rounds
+        while (round <= n) {
+            int first = (round % 2 == 1) ? 0 : 1;
+            int partner = -1;
+            if (id >= first) {
+                partner = (id - first) % 2 == 0 ? id + 1 : id - 1;
+            }
+            if (partner < 0 || partner >= n) {
+                round++;
+                continue;
+            }
+            if (!sent) {
+                Message msg = {id, round, value, false, sizeof(int)};
+                sim.send(id, partner, msg);
+                sent = true;
+            }
+            if (!has(partner, round)) {
+                return;
+            }
+            int other = take(partner, round).value;
+            value = partner > id ? std::min(value, other) : std::max(value, other);
+            sent = false;
+            round++;
+        }
+    }
+
+    int id, n;
+    long round;
+    bool sent;
+};
+
+// ----- Sasaki's Time Optimal Sort -----
+// Process id holds lValue/rValue with their marks and the area counter. In
+// every round it sends lValue left and rValue right, then applies both
+// boundary exchanges and the local exchange, as in the shared-memory version.
+class SasakiProcess : public SimProcess {
+public:
+    SasakiProcess(int id, int n, int lValue, int rValue, bool lMarked, bool rMarked, int area)
+        : lValue(lValue), rValue(rValue), lMarked(lMarked), rMarked(rMarked), area(area),
+          id(id), n(n), round(1), sent(false) {}
+
+    void start(Simulator& sim) { advance(sim); }
+    void receive(Simulator& sim) { advance(sim); }
+
+    // Sorted output of this node according to the rule based on area
+    int output() const { return area == -1 ? rValue : lValue; }
+
+    int lValue, rValue;
+    bool lMarked, rMarked;
+    int area;
+
+private:
+    void advance(Simulator& sim) {
+        // For n - 1 rounds
+        while (round < n) {
+            if (!sent) {
+                if (id > 0) {
+                    Message msg = {id, round, lValue, lMarked, sizeof(int) + 1};
+                    sim.send(id, id - 1, msg);
+                }
+                if (id < n - 1) {
+                    Message msg = {id, round, rValue, rMarked, sizeof(int) + 1};
+                    sim.send(id, id + 1, msg);
+                }
+                sent = true;
+            }
+            if ((id > 0 && !has(id - 1, round)) || (id < n - 1 && !has(id + 1, round))) {
+                return;
+            }
+            if (id > 0) {
+                Message left = take(id - 1, round);
+                if (left.value > lValue) {
+                    // if marked element moves left, increase the area; if it moves right, decrease it
+                    area += (lMarked ? 1 : 0) - (left.marked ? 1 : 0);
+                    lValue = left.value;
+                    lMarked = left.marked;
+                }
+            }
+            if (id < n - 1) {
+                Message right = take(id + 1, round);
+                if (right.value < rValue) {
+                    rValue = right.value;
+                    rMarked = right.marked;
+                }
+            }
+            if (lValue > rValue) {
+                std::swap(lValue, rValue);
+                std::swap(lMarked, rMarked);
+            }
+            sent = false;
+            round++;
+        }
+    }
+
+    int id, n;
+    long round;
+    bool sent;
+};
+
+// ----- Alternate Time Optimal Sort -----
+// In round i the centers are the processes at firstCenter(i) mod 3. The two
+// neighbours of a center send it their values, the center sorts the triplet
+// (or the pair at either end) and replies with their new values.
+class AlternateProcess : public SimProcess {
+public:
+    AlternateProcess(int id, int n, int value) : value(value), id(id), n(n), round(1), sent(false) {}
+
+    void start(Simulator& sim) { advance(sim); }
+    void receive(Simulator& sim) { advance(sim); }
+
+    int value;
+
+private:
+    void advance(Simulator& sim) {
+        // For n - 1 rounds
+        while (round < n) {
+            int offset = ((id - firstCenter(round)) % 3 + 3) % 3;
+            if (offset == 0) {
+                if (!centerStep(sim)) return;
+            } else {
+                // offset 2: left neighbour of center id + 1, offset 1: right neighbour of id - 1
+                int center = offset == 2 ? id + 1 : id - 1;
+                if (center >= 0 && center < n) {
+                    if (!sent) {
+                        Message msg = {id, round, value, false, sizeof(int)};
+                        sim.send(id, center, msg);
+                        sent = true;
+                    }
+                    if (!has(center, round)) return;
+                    value = take(center, round).value;
+                }
+            }
+            sent = false;
+            round++;
+        }
+    }
+
+    // Sorts the triplet around this center once both neighbours have reported
+    bool centerStep(Simulator& sim) {
+        bool hasLeft = id - 1 >= 0, hasRight = id + 1 < n;
+        if ((hasLeft && !has(id - 1, round)) || (hasRight && !has(id + 1, round))) {
+            return false;
+        }
+        // Local copy of the triplet, with this center at index 1 (0 without a left neighbour)
+        int triplet[3];
+        long count = 0;
+        if (hasLeft) triplet[count++] = take(id - 1, round).value;
+        long center = count;
+        triplet[count++] = value;
+        if (hasRight) triplet[count++] = take(id + 1, round).value;
+        sortTriplet(triplet, count, center);
+        int left = triplet[0];
+        int right = triplet[count - 1];
+        value = triplet[center];
+        if (hasLeft) {
+            Message msg = {id, round, left, false, sizeof(int)};
+            sim.send(id, id - 1, msg);
+        }
+        if (hasRight) {
+            Message msg = {id, round, right, false, sizeof(int)};
+            sim.send(id, id + 1, msg);
+        }
+        return true;
+    }
+
+    int id, n;
+    long round;
+    bool sent;
+};
+
+// Runs odd-even transposition sort with one simulated process per element
+inline SimReport simulateOddEvenTranspositionSort(std::vector<int>& arr, const LinkModel& link) {
+    int n = arr.size();
+    std::vector<OddEvenProcess> nodes;
+    nodes.reserve(n);
+    std::vector<SimProcess*> processes;
+    for (int i = 0; i < n; i++) {
+        nodes.push_back(OddEvenProcess(i, n, arr[i]));
+        processes.push_back(&nodes.back());
+    }
+    SimReport report = Simulator(processes, link).run();
+    for (int i = 0; i < n; i++) {
+        arr[i] = nodes[i].value;
+    }
+    return report;
+}
+
+// Runs Sasaki's algorithm with one simulated process node per element
+inline SimReport simulateSasakiTimeOptimalSort(std::vector<int>& arr, std::vector<int>& result, const LinkModel& link) {
+    int n = arr.size();
+    std::vector<SasakiProcess> nodes;
+    nodes.reserve(n);
+    std::vector<SimProcess*> processes;
+    for (int i = 0; i < n; i++) {
+        if (i == 0) {
+            nodes.push_back(SasakiProcess(i, n, INT_MIN, arr[i], false, true, -1));
+        } else if (i == n - 1) {
+            nodes.push_back(SasakiProcess(i, n, arr[i], INT_MAX, true, false, 0));
+        } else {
+            nodes.push_back(SasakiProcess(i, n, arr[i], arr[i], false, false, 0));
+        }
+        processes.push_back(&nodes.back());
+    }
+    SimReport report = Simulator(processes, link).run();
+    result.resize(n);
+    for (int i = 0; i < n; i++) {
+        result[i] = nodes[i].output();
+    }
+    return report;
+}
+
+// Runs the alternate (mod-3) sort with one simulated process per element
+inline SimReport simulateAlternateTimeOptimalSorting(std::vector<int>& arr, const LinkModel& link) {
+    int n = arr.size();
+    std::vector<AlternateProcess> nodes;
+    nodes.reserve(n);
+    std::vector<SimProcess*> processes;
+    for (int i = 0; i < n; i++) {
+        nodes.push_back(AlternateProcess(i, n, arr[i]));
+        processes.push_back(&nodes.back());
+    }
+    SimReport report = Simulator(processes, link).run();
+    for (int i = 0; i < n; i++) {
+        arr[i] = nodes[i].value;
+    }
+    return report;
+}
+
+#endif
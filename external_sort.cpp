@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include "external_sort.h"
+using namespace std;
+
+// Writes keys random ints to path in blocks; returns false on an IO error
+bool generateFile(const string& path, long keys, unsigned seed) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    mt19937 gen(seed);
+    vector<int> block(1 << 20);
+    bool ok = true;
+    for (long done = 0; done < keys && ok; done += block.size()) {
+        long length = min<long>(block.size(), keys - done);
+        for (long i = 0; i < length; i++) {
+            block[i] = static_cast<int>(gen());
+        }
+        ok = fwrite(block.data(), sizeof(int), length, file) == static_cast<size_t>(length);
+    }
+    return fclose(file) == 0 && ok;
+}
+
+// Streams a key file; returns its key count, whether it is sorted and the
+// sum of its keys (mod 2^64) so input and output can be compared
+bool scanFile(const string& path, long& keys, bool& sorted, unsigned long long& sum) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    vector<int> block(1 << 20);
+    keys = 0;
+    sorted = true;
+    sum = 0;
+    int last = 0;
+    size_t length;
+    while ((length = fread(block.data(), sizeof(int), block.size(), file)) > 0) {
+        for (size_t i = 0; i < length; i++) {
+            if (keys > 0 && block[i] < last) {
+                sorted = false;
+            }
+            last = block[i];
+            sum += static_cast<unsigned>(block[i]);
+            keys++;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+int sortFile(const string& input, const string& output, long memoryBytes, int threads) {
+    WorkerPool pool(threads);
+    long inputKeys = 0;
+    bool inputSorted = false;
+    unsigned long long inputSum = 0;
+    if (!scanFile(input, inputKeys, inputSorted, inputSum)) {
+        cerr << "Cannot read " << input << endl;
+        return 1;
+    }
+
+    double writeMBps = 0, readMBps = 0;
+    long probeBytes = min<long>(max<long>(inputKeys * sizeof(int), 64L << 20), 1L << 30);
+    measureDiskBandwidth(output + ".probe", probeBytes, writeMBps, readMBps);
+
+    ExternalSortReport report = externalSort(input, output, memoryBytes, pool);
+
+    long outputKeys = 0;
+    bool outputSorted = false;
+    unsigned long long outputSum = 0;
+    bool correct = report.ok && scanFile(output, outputKeys, outputSorted, outputSum) &&
+                   outputSorted && outputKeys == inputKeys && outputSum == inputSum;
+
+    cout << "=== External Sort (" << memoryBytes / (1 << 20) << " MiB of keys in RAM, "
+         << pool.size() << " threads) ===" << endl;
+    cout << "Raw disk: " << fixed << setprecision(1) << writeMBps << " MB/s write, "
+         << readMBps << " MB/s read" << endl << endl;
+    cout << left << setw(12) << "Keys" << setw(8) << "Runs" << setw(12) << "Runs(ms)" << setw(12) << "Merge(ms)"
+         << setw(14) << "IO wait(ms)" << setw(12) << "Sort MB/s" << setw(12) << "IO MB/s" << "Verification" << endl;
+    cout << left << setw(12) << report.keys << setw(8) << report.runs
+         << setw(12) << setprecision(1) << report.runMs << setw(12) << report.mergeMs
+         << setw(14) << report.ioWaitMs << setw(12) << report.sortMegabytesPerSecond
+         << setw(12) << report.ioMegabytesPerSecond << (correct ? "Correct" : "Incorrect") << endl;
+    return correct ? 0 : 1;
+}
+
+// Usage:
+//   external_sort generate <file> <keys> [seed]
+//   external_sort sort <input> <output> [memory MiB, default 256] [threads]
+// Without arguments it sorts 2^24 generated keys with 16 MiB of RAM, i.e.
+// 16 runs, in the current directory.
+int main(int argc, char* argv[]) {
+    string command = argc > 1 ? argv[1] : "";
+    if (command == "generate" && argc > 3) {
+        unsigned seed = argc > 4 ? strtoul(argv[4], nullptr, 10) : 42;
+        return generateFile(argv[2], atol(argv[3]), seed) ? 0 : 1;
+    }
+    if (command == "sort" && argc > 3) {
+        long memory = (argc > 4 ? atol(argv[4]) : 256) << 20;
+        int threads = argc > 5 ? atoi(argv[5]) : 0;
+        return sortFile(argv[2], argv[3], memory, threads);
+    }
+    if (argc > 1) {
+        cerr << "Usage: " << argv[0] << " generate <file> <keys> [seed]" << endl
+             << "       " << argv[0] << " sort <input> <output> [memory MiB] [threads]" << endl;
+        return 1;
+    }
+
+    string input = "external_input.bin", output = "external_output.bin";
+    if (!generateFile(input, 1L << 24, 42)) {
+        cerr << "Cannot write " << input << endl;
+        return 1;
+    }
+    int status = sortFile(input, output, 16L << 20, 0);
+    remove(input.c_str());
+    remove(output.c_str());
+    return status;
+}
@@ -0,0 +1,412 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hybrid_sort.h"
+#include "worker_pool.h"
+
+// Asynchronous file IO on a few background threads, the portable stand-in
+// for io_uring: read() and write() queue a pread/pwrite and return a ticket
+// at once, wait() blocks until that transfer is done. Reads and writes go to
+// separate threads, so read-ahead and write-behind overlap each other as
+// well as the sorting on the caller's side. Time spent blocked in wait() is
+// summed up, which is how much of the IO the pipeline failed to hide.
+class AsyncIo {
+public:
+    AsyncIo() : nextTicket(0), stopping(false), blockedMs(0) {
+        for (int q = 0; q < 2; q++) {
+            threads.push_back(std::thread([this, q]() { serve(q); }));
+        }
+    }
+
+    ~AsyncIo() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        queued.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    AsyncIo(const AsyncIo&) = delete;
+    AsyncIo& operator=(const AsyncIo&) = delete;
+
+    long read(int fd, void* buffer, size_t bytes, off_t offset) {
+        return submit(READ_QUEUE, fd, buffer, bytes, offset);
+    }
+
+    long write(int fd, const void* buffer, size_t bytes, off_t offset) {
+        return submit(WRITE_QUEUE, fd, const_cast<void*>(buffer), bytes, offset);
+    }
+
+    // Bytes transferred by the ticket's request, -1 on an IO error
+    long wait(long ticket) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::unique_lock<std::mutex> lock(mtx);
+        finished.wait(lock, [&]() { return results.count(ticket) != 0; });
+        long bytes = results[ticket];
+        results.erase(ticket);
+        std::chrono::duration<double, std::milli> blocked = std::chrono::high_resolution_clock::now() - start;
+        blockedMs += blocked.count();
+        return bytes;
+    }
+
+    // Total time callers spent in wait()
+    double waitMilliseconds() const { return blockedMs; }
+
+private:
+    enum { READ_QUEUE, WRITE_QUEUE };
+
+    struct Request {
+        long ticket;
+        int fd;
+        char* buffer;
+        size_t bytes;
+        off_t offset;
+    };
+
+    long submit(int queue, int fd, void* buffer, size_t bytes, off_t offset) {
+        long ticket;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ticket = nextTicket++;
+            Request request = {ticket, fd, static_cast<char*>(buffer), bytes, offset};
+            requests[queue].push_back(request);
+        }
+        queued.notify_all();
+        return ticket;
+    }
+
+    void serve(int queue) {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                queued.wait(lock, [&]() { return stopping || !requests[queue].empty(); });
+                if (requests[queue].empty()) {
+                    return;
+                }
+                request = requests[queue].front();
+                requests[queue].pop_front();
+            }
+            long done = transfer(queue == WRITE_QUEUE, request);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                results[request.ticket] = done;
+            }
+            finished.notify_all();
+        }
+    }
+
+    // pread/pwrite until everything moved; short reads end at end of file
+    static long transfer(bool write, const Request& request) {
+        size_t done = 0;
+        while (done < request.bytes) {
+            ssize_t moved = write ? pwrite(request.fd, request.buffer + done, request.bytes - done, request.offset + done)
+                                  : pread(request.fd, request.buffer + done, request.bytes - done, request.offset + done);
+            if (moved < 0) {
+                return -1;
+            }
+            if (moved == 0) {
+                break;
+            }
+            done += moved;
+        }
+        return static_cast<long>(done);
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable queued, finished;
+    std::deque<Request> requests[2];
+    std::map<long, long> results;
+    long nextTicket;
+    bool stopping;
+    double blockedMs;
+};
+
+// What an external sort did. Bytes moved count every read and write of keys.
+struct ExternalSortReport {
+    bool ok;
+    long keys;
+    long runs;
+    double runMs;
+    double mergeMs;
+    double totalMs;
+    // Time the pipeline stalled on IO that was not hidden behind sorting
+    double ioWaitMs;
+    double bytesMoved;
+    // Input size over the total time, and bytes moved over the total time
+    double sortMegabytesPerSecond;
+    double ioMegabytesPerSecond;
+};
+
+inline double elapsedMs(std::chrono::high_resolution_clock::time_point since) {
+    std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - since;
+    return duration.count();
+}
+
+// Run formation: reads runKeys keys at a time, sorts them with the hybrid
+// sort on the pool and writes them back as one sorted run of the run file.
+// Three buffers rotate, so run r + 1 is read and run r - 1 written while run
+// r is sorted. Returns the number of runs, -1 on an IO error.
+inline long formRuns(int in, int out, long keys, long runKeys, WorkerPool& pool, AsyncIo& io,
+                     ExternalSortReport& report) {
+    long runs = (keys + runKeys - 1) / runKeys;
+    std::vector<int> buffers[3];
+    long reads[3] = {-1, -1, -1}, writes[3] = {-1, -1, -1};
+    bool ok = true;
+
+    auto runLength = [&](long r) { return std::min(runKeys, keys - r * runKeys); };
+    auto startRead = [&](long r) {
+        std::vector<int>& buffer = buffers[r % 3];
+        if (writes[r % 3] >= 0) {
+            ok = io.wait(writes[r % 3]) >= 0 && ok;
+            writes[r % 3] = -1;
+        }
+        buffer.resize(runLength(r));
+        reads[r % 3] = io.read(in, buffer.data(), buffer.size() * sizeof(int), r * runKeys * sizeof(int));
+    };
+
+    if (runs > 0) {
+        startRead(0);
+    }
+    for (long r = 0; r < runs && ok; r++) {
+        std::vector<int>& buffer = buffers[r % 3];
+        ok = io.wait(reads[r % 3]) == static_cast<long>(buffer.size() * sizeof(int));
+        reads[r % 3] = -1;
+        if (r + 1 < runs) {
+            startRead(r + 1);
+        }
+        hybridSort(buffer, pool, TILE_ODD_EVEN);
+        writes[r % 3] = io.write(out, buffer.data(), buffer.size() * sizeof(int), r * runKeys * sizeof(int));
+        report.bytesMoved += 2.0 * buffer.size() * sizeof(int);
+    }
+    // Nothing may still target the buffers once they go, even after an error
+    for (int b = 0; b < 3; b++) {
+        if (reads[b] >= 0) {
+            io.wait(reads[b]);
+        }
+        if (writes[b] >= 0) {
+            ok = io.wait(writes[b]) >= 0 && ok;
+        }
+    }
+    return ok ? runs : -1;
+}
+
+// k-way merge of the sorted runs of the run file into out. Every run streams
+// through two blocks: the merge consumes one while the next is read ahead.
+// Output goes through two blocks the same way, written behind. Returns false
+// on an IO error.
+inline bool mergeRuns(int in, int out, long keys, long runKeys, long runs, long blockKeys, AsyncIo& io,
+                      ExternalSortReport& report) {
+    struct RunStream {
+        std::vector<int> blocks[2];
+        long pending;
+        long next;
+        long end;
+        long position;
+        int current;
+    };
+    std::vector<RunStream> streams(runs);
+    bool ok = true;
+
+    // Queues the read of the run's next block into its idle block
+    auto readAhead = [&](RunStream& stream) {
+        std::vector<int>& block = stream.blocks[1 - stream.current];
+        long length = std::min(blockKeys, stream.end - stream.next);
+        block.resize(length);
+        stream.pending = length > 0 ? io.read(in, block.data(), length * sizeof(int), stream.next * sizeof(int)) : -1;
+        stream.next += length;
+        report.bytesMoved += static_cast<double>(length) * sizeof(int);
+    };
+    // Switches to the block read ahead; false once the run is exhausted
+    auto advance = [&](RunStream& stream) {
+        if (stream.pending < 0) {
+            return false;
+        }
+        std::vector<int>& block = stream.blocks[1 - stream.current];
+        ok = io.wait(stream.pending) == static_cast<long>(block.size() * sizeof(int)) && ok;
+        stream.current = 1 - stream.current;
+        stream.position = 0;
+        readAhead(stream);
+        return true;
+    };
+
+    typedef std::pair<int, long> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+    for (long r = 0; r < runs; r++) {
+        RunStream& stream = streams[r];
+        stream.next = r * runKeys;
+        stream.end = std::min(keys, stream.next + runKeys);
+        stream.current = 0;
+        stream.position = 0;
+        readAhead(stream);
+        if (advance(stream)) {
+            heads.push(Head(stream.blocks[stream.current][0], r));
+        }
+    }
+
+    std::vector<int> output[2];
+    long writes[2] = {-1, -1};
+    int current = 0;
+    long written = 0;
+    output[0].reserve(blockKeys);
+    output[1].reserve(blockKeys);
+    auto flush = [&]() {
+        std::vector<int>& block = output[current];
+        writes[current] = io.write(out, block.data(), block.size() * sizeof(int), written * sizeof(int));
+        written += block.size();
+        report.bytesMoved += static_cast<double>(block.size()) * sizeof(int);
+        current = 1 - current;
+        if (writes[current] >= 0) {
+            ok = io.wait(writes[current]) >= 0 && ok;
+            writes[current] = -1;
+        }
+        output[current].clear();
+    };
+
+    while (!heads.empty() && ok) {
+        long r = heads.top().second;
+        output[current].push_back(heads.top().first);
+        heads.pop();
+        if (static_cast<long>(output[current].size()) == blockKeys) {
+            flush();
+        }
+        RunStream& stream = streams[r];
+        if (++stream.position < static_cast<long>(stream.blocks[stream.current].size()) || advance(stream)) {
+            heads.push(Head(stream.blocks[stream.current][stream.position], r));
+        }
+    }
+    if (!output[current].empty()) {
+        flush();
+    }
+    for (int b = 0; b < 2; b++) {
+        if (writes[b] >= 0) {
+            ok = io.wait(writes[b]) >= 0 && ok;
+        }
+    }
+    for (RunStream& stream : streams) {
+        if (stream.pending >= 0) {
+            io.wait(stream.pending);
+        }
+    }
+    return ok && written == keys;
+}
+
+// Sorts the native-endian int32 keys of the file input into output using at
+// most about memoryBytes of RAM for keys. Runs of memoryBytes / 4 keys (one
+// buffer is sorted, one read, one written, plus the hybrid sort's scratch)
+// are sorted on the pool; if there is more than one, they are k-way merged
+// from a temporary run file next to the output, which is removed afterwards.
+// The output is flushed to disk before the clock stops.
+inline ExternalSortReport externalSort(const std::string& input, const std::string& output, long memoryBytes,
+                                       WorkerPool& pool) {
+    ExternalSortReport report = {false, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    // Tile size tuning happens once per process and is not part of the sort
+    tunedTileSize(TILE_ODD_EVEN);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    int in = open(input.c_str(), O_RDONLY);
+    struct stat info;
+    if (in < 0 || fstat(in, &info) != 0) {
+        if (in >= 0) close(in);
+        return report;
+    }
+    long keys = info.st_size / sizeof(int);
+    long runKeys = std::max(1024L, memoryBytes / 4 / static_cast<long>(sizeof(int)));
+    long runs = (keys + runKeys - 1) / runKeys;
+    std::string runPath = output + ".runs";
+    // A single run is written straight to the output
+    int out = open((runs > 1 ? runPath : output).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return report;
+    }
+
+    AsyncIo io;
+    report.keys = keys;
+    report.runs = formRuns(in, out, keys, runKeys, pool, io, report);
+    report.runMs = elapsedMs(start);
+    bool ok = report.runs >= 0;
+    close(in);
+
+    if (ok && runs > 1) {
+        auto mergeStart = std::chrono::high_resolution_clock::now();
+        int merged = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        // Two blocks per run and two for the output share the memory
+        long blockKeys = std::max(1024L, memoryBytes / static_cast<long>(sizeof(int)) / (2 * runs + 2));
+        ok = merged >= 0 && mergeRuns(out, merged, keys, runKeys, runs, blockKeys, io, report);
+        if (merged >= 0) {
+            ok = fdatasync(merged) == 0 && ok;
+            close(merged);
+        }
+        close(out);
+        unlink(runPath.c_str());
+        report.mergeMs = elapsedMs(mergeStart);
+    } else {
+        ok = fdatasync(out) == 0 && ok;
+        close(out);
+    }
+
+    report.ok = ok;
+    report.totalMs = elapsedMs(start);
+    report.ioWaitMs = io.waitMilliseconds();
+    report.sortMegabytesPerSecond = keys * sizeof(int) / 1e6 / (report.totalMs / 1000);
+    report.ioMegabytesPerSecond = report.bytesMoved / 1e6 / (report.totalMs / 1000);
+    return report;
+}
+
+// Raw sequential bandwidth of the disk holding path: writes bytes in 8 MiB
+// blocks and flushes them, then drops the file from the page cache and reads
+// it back. The file is removed afterwards. MB/s are 0 on an IO error.
+inline void measureDiskBandwidth(const std::string& path, long bytes, double& writeMBps, double& readMBps) {
+    writeMBps = readMBps = 0;
+    const long block = 8 << 20;
+    std::vector<char> buffer(block, 1);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    bool ok = true;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (long done = 0; done < bytes && ok; done += block) {
+        ok = pwrite(fd, buffer.data(), block, done) == block;
+    }
+    ok = ok && fdatasync(fd) == 0;
+    double writeMs = elapsedMs(start);
+
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    start = std::chrono::high_resolution_clock::now();
+    for (long done = 0; done < bytes && ok; done += block) {
+        ok = pread(fd, buffer.data(), block, done) == block;
+    }
+    double readMs = elapsedMs(start);
+    close(fd);
+    unlink(path.c_str());
+    if (ok) {
+        long total = (bytes + block - 1) / block * block;
+        writeMBps = total / 1e6 / (writeMs / 1000);
+        readMBps = total / 1e6 / (readMs / 1000);
+    }
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef HYBRID_SORT_H
+#define HYBRID_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#include "alternative_time_optimal_sort.h"
+#include "odd_even_transposition_sort.h"
+#include "worker_pool.h"
+
+// Network that sorts the tiles of the hybrid sort
+enum TileNetwork { TILE_ODD_EVEN, TILE_ALTERNATE };
+
+inline const char* tileNetworkName(TileNetwork network) {
+    return network == TILE_ALTERNATE ? "alternate" : "odd-even";
+}
+
+// Tile networks for any key type with operator<: the same rounds as the int
+// kernels, one compare-exchange or triplet at a time
+template <class T>
+inline void sortTile(T* data, long len, TileNetwork network) {
+    if (network == TILE_ALTERNATE) {
+        for (long i = 1; i < len; i++) {
+            for (long center = firstCenter(i); center < len; center += 3) {
+                sortTriplet(data, len, center);
+            }
+        }
+    } else {
+        for (long i = 1; i <= len; i++) {
+            for (long index = (i % 2 == 1) ? 0 : 1; index + 1 < len; index += 2) {
+                compareExchange(data, index);
+            }
+        }
+    }
+}
+
+// int keys take the SIMD kernels
+inline void sortTile(int* data, long len, TileNetwork network) {
+    if (network == TILE_ALTERNATE) {
+        alternateTimeOptimalSortingTile(data, len);
+    } else {
+        oddEvenTranspositionSortTile(data, len);
+    }
+}
+
+// Sorts [begin, end) of buffers[0] as tiles of the given size and merges the
+// tiles pairwise into one run, which ends up in buffers[target]. Merges ping
+// pong between the buffers, so the tiles are sorted in whichever buffer makes
+// the pass count come out right (copying the keys over first if needed).
+template <class T>
+inline void sortTiledRange(T* buffers[2], int target, long begin, long end, long tile, TileNetwork network) {
+    long len = end - begin;
+    int passes = 0;
+    for (long width = tile; width < len; width *= 2) {
+        passes++;
+    }
+    T* src = buffers[passes % 2 == 0 ? target : 1 - target];
+    T* dst = src == buffers[0] ? buffers[1] : buffers[0];
+    if (src != buffers[0]) {
+        std::copy(buffers[0] + begin, buffers[0] + end, src + begin);
+    }
+
+    for (long t = begin; t < end; t += tile) {
+        sortTile(src + t, std::min(tile, end - t), network);
+    }
+    for (long width = tile; width < len; width *= 2) {
+        for (long s = begin; s < end; s += 2 * width) {
+            long mid = std::min(s + width, end), last = std::min(s + 2 * width, end);
+            std::merge(src + s, src + mid, src + mid, src + last, dst + s);
+        }
+        std::swap(src, dst);
+    }
+}
+
+// Multiway merge path: how many keys of each of the sorted runs come before
+// output position rank of their merge. It finds the smallest key v with at
+// least rank keys <= v (a binary search within every run, counting across
+// all runs), takes every key below v and hands the rank left over to the
+// keys equal to v, lower runs first. Splits of growing ranks therefore never
+// move back, and neighbouring workers meet exactly.
+template <class T>
+inline void multiwaySplit(const std::vector<const T*>& runs, const std::vector<long>& lengths,
+                          long rank, std::vector<long>& split) {
+    long k = runs.size();
+    split.assign(k, 0);
+    if (rank <= 0) {
+        return;
+    }
+    auto atMost = [&](const T& value) {
+        long count = 0;
+        for (long r = 0; r < k; r++) {
+            count += std::upper_bound(runs[r], runs[r] + lengths[r], value) - runs[r];
+        }
+        return count;
+    };
+    const T* value = nullptr;
+    for (long r = 0; r < k; r++) {
+        long lo = 0, hi = lengths[r];
+        while (lo < hi) {
+            long mid = lo + (hi - lo) / 2;
+            if (atMost(runs[r][mid]) >= rank) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        if (lo < lengths[r] && (!value || runs[r][lo] < *value)) {
+            value = runs[r] + lo;
+        }
+    }
+    if (!value) {
+        split = lengths;
+        return;
+    }
+    long remaining = rank;
+    for (long r = 0; r < k; r++) {
+        split[r] = std::lower_bound(runs[r], runs[r] + lengths[r], *value) - runs[r];
+        remaining -= split[r];
+    }
+    for (long r = 0; r < k && remaining > 0; r++) {
+        long equal = std::upper_bound(runs[r], runs[r] + lengths[r], *value) - runs[r] - split[r];
+        long take = std::min(remaining, equal);
+        split[r] += take;
+        remaining -= take;
+    }
+}
+
+// k-way merge of the slices [from[r], to[r]) of the runs into out
+template <class T>
+inline void multiwayMerge(const std::vector<const T*>& runs, const std::vector<long>& from,
+                          const std::vector<long>& to, T* out) {
+    typedef std::pair<T, long> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+    std::vector<long> next(from);
+    for (long r = 0; r < static_cast<long>(runs.size()); r++) {
+        if (next[r] < to[r]) {
+            heads.push(Head(runs[r][next[r]], r));
+        }
+    }
+    while (!heads.empty()) {
+        long r = heads.top().second;
+        *out++ = heads.top().first;
+        heads.pop();
+        if (++next[r] < to[r]) {
+            heads.push(Head(runs[r][next[r]], r));
+        }
+    }
+}
+
+// Hybrid sort: every worker sorts its share as L1-sized tiles with the tile
+// network and merges the tiles into one run; then the p runs are combined by
+// a p-way merge in which worker w writes output positions [begin, end) of
+// its chunk, located in every run by multiwaySplit. A single barrier
+// separates the phases, and the networks only ever run on L1-resident tiles.
+// Sorts data in place with scratch as the merge buffer (n keys each), so it
+// also works on memory the caller mapped or allocated itself.
+template <class T>
+inline double hybridSort(T* data, T* scratch, long n, WorkerPool& pool, TileNetwork network, long tile) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long p = pool.size();
+    T* buffers[2] = {data, scratch};
+    // With one worker the tile merges already write the final order
+    int target = p > 1 ? 1 : 0;
+    std::vector<const T*> runs(p);
+    std::vector<long> lengths(p);
+
+    pool.run([&](int worker) {
+        SORT_TRACE_BEGIN("tiles", -1);
+        long begin, end;
+        pool.chunk(n, worker, begin, end);
+        sortTiledRange(buffers, target, begin, end, tile, network);
+        runs[worker] = buffers[target] + begin;
+        lengths[worker] = end - begin;
+        SORT_TRACE_END("tiles", -1);
+        pool.barrier(worker);
+        if (p == 1) {
+            return;
+        }
+
+        SORT_TRACE_BEGIN("merge", -1);
+        std::vector<long> from, to;
+        multiwaySplit(runs, lengths, begin, from);
+        multiwaySplit(runs, lengths, end, to);
+        multiwayMerge(runs, from, to, buffers[0] + begin);
+        SORT_TRACE_END("merge", -1);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+inline double hybridSort(std::vector<int>& arr, WorkerPool& pool, TileNetwork network, long tile) {
+    std::vector<int> scratch(arr.size());
+    return hybridSort(arr.data(), scratch.data(), arr.size(), pool, network, tile);
+}
+
+// L1 data cache size in bytes, 32 KiB where the system does not report it
+inline long l1DataCacheBytes() {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    long bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (bytes > 0) {
+        return bytes;
+    }
+#endif
+    return 32 * 1024;
+}
+
+// Tile size that sorts fastest on this machine: times one worker's tile
+// sorts and tile merges on sampleSize random keys for every power of two
+// from 4 up to a quarter of L1 (at most 1024) and keeps the best of three
+// runs each. The network does O(tile) work per key and the merges
+// O(log(n / tile)), so the winner depends on the SIMD width and the caches.
+inline long tuneTileSize(TileNetwork network, long sampleSize = 1 << 16) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> distrib(INT_MIN, INT_MAX);
+    std::vector<int> sample(sampleSize);
+    for (long i = 0; i < sampleSize; i++) {
+        sample[i] = distrib(gen);
+    }
+
+    long limit = std::min(1024L, l1DataCacheBytes() / 4 / static_cast<long>(sizeof(int)));
+    long best = 4;
+    double bestTime = 0;
+    std::vector<int> keys, scratch(sampleSize);
+    for (long tile = 4; tile <= limit; tile *= 2) {
+        double fastest = 0;
+        for (int run = 0; run < 3; run++) {
+            keys = sample;
+            int* buffers[2] = {keys.data(), scratch.data()};
+            auto start = std::chrono::high_resolution_clock::now();
+            sortTiledRange(buffers, 0, 0, sampleSize, tile, network);
+            std::chrono::duration<double> time = std::chrono::high_resolution_clock::now() - start;
+            if (run == 0 || time.count() < fastest) {
+                fastest = time.count();
+            }
+        }
+        if (tile == 4 || fastest < bestTime) {
+            best = tile;
+            bestTime = fastest;
+        }
+    }
+    return best;
+}
+
+// Tuned tile size of a network, measured once per process on first use
+inline long tunedTileSize(TileNetwork network) {
+    if (network == TILE_ALTERNATE) {
+        static const long alternate = tuneTileSize(TILE_ALTERNATE);
+        return alternate;
+    }
+    static const long oddEven = tuneTileSize(TILE_ODD_EVEN);
+    return oddEven;
+}
+
+inline double hybridSort(std::vector<int>& arr, WorkerPool& pool, TileNetwork network) {
+    return hybridSort(arr, pool, network, tunedTileSize(network));
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include "hybrid_sort.h"
+#include "mapped_file.h"
+using namespace std;
+
+struct KeyFileOptions {
+    string path;
+    string type;
+    string engine;
+    int threads;
+    bool hugePages;
+    // Keys to generate into the file before sorting, -1 to sort it as is
+    long generate;
+    unsigned seed;
+};
+
+// Fills keys with random values of the key type (floats in [-1e9, 1e9], so never NaN)
+template <class T>
+void fillRandom(T* keys, long n, unsigned seed) {
+    mt19937_64 gen(seed);
+    for (long i = 0; i < n; i++) {
+        keys[i] = static_cast<T>(gen());
+    }
+}
+
+template <>
+void fillRandom<float>(float* keys, long n, unsigned seed) {
+    mt19937_64 gen(seed);
+    uniform_real_distribution<float> distrib(-1e9f, 1e9f);
+    for (long i = 0; i < n; i++) {
+        keys[i] = distrib(gen);
+    }
+}
+
+// "advised, 510.0 of 512.0 MB on huge pages", or "not advised"
+string hugePageReport(bool advised, long hugeBytes, size_t bytes) {
+    if (!advised) {
+        return "not advised";
+    }
+    ostringstream report;
+    report << "advised, ";
+    if (hugeBytes < 0) {
+        report << "backing unknown";
+    } else {
+        report << fixed << setprecision(1) << hugeBytes / 1e6 << " of " << bytes / 1e6 << " MB on huge pages";
+    }
+    return report.str();
+}
+
+// Maps the file, sorts its keys in place with the selected engine and msyncs
+// them back. Returns false if the file cannot be mapped or the result is not
+// sorted.
+template <class T>
+bool sortKeyFile(const KeyFileOptions& options) {
+    auto start = chrono::high_resolution_clock::now();
+    long size = options.generate >= 0 ? options.generate * static_cast<long>(sizeof(T)) : -1;
+    MappedFile file(options.path, size, options.hugePages);
+    if (!file.valid() || file.bytes() % sizeof(T) != 0) {
+        cerr << "Cannot map " << options.path << " as " << options.type << " keys" << endl;
+        return false;
+    }
+    long n = file.bytes() / sizeof(T);
+    T* keys = file.data<T>();
+    if (options.generate >= 0) {
+        fillRandom(keys, n, options.seed);
+    }
+    MappedBuffer scratch(options.engine == "std::sort" ? 0 : file.bytes(), options.hugePages);
+    if (!scratch.valid()) {
+        cerr << "Cannot allocate the merge buffer" << endl;
+        return false;
+    }
+    chrono::duration<double, milli> mapTime = chrono::high_resolution_clock::now() - start;
+
+    WorkerPool pool(options.threads);
+    // The tile size is tuned once on int keys and kept for every key type
+    TileNetwork network = options.engine == "hybrid-alternate" ? TILE_ALTERNATE : TILE_ODD_EVEN;
+    long tile = tunedTileSize(network);
+    auto sortStart = chrono::high_resolution_clock::now();
+    if (options.engine == "std::sort") {
+        sort(keys, keys + n);
+    } else {
+        hybridSort(keys, scratch.data<T>(), n, pool, network, tile);
+    }
+    chrono::duration<double, milli> sortTime = chrono::high_resolution_clock::now() - sortStart;
+
+    bool sorted = is_sorted(keys, keys + n);
+    auto syncStart = chrono::high_resolution_clock::now();
+    bool synced = file.sync();
+    chrono::duration<double, milli> syncTime = chrono::high_resolution_clock::now() - syncStart;
+
+    cout << "=== " << options.path << " (" << options.type << ", " << options.engine << ", "
+         << pool.size() << " threads) ===" << endl;
+    // Measured after the sort, when every page has been touched
+    cout << "Huge pages: file " << hugePageReport(file.hugePagesAdvised(), file.hugePageBytes(), file.bytes())
+         << ", merge buffer " << hugePageReport(scratch.hugePagesAdvised(), scratch.hugePageBytes(), scratch.bytes())
+         << endl << endl;
+    cout << left << setw(14) << "Keys" << setw(12) << "Map(ms)" << setw(12) << "Sort(ms)" << setw(12) << "Sync(ms)"
+         << setw(16) << "Keys/s" << setw(12) << "MB/s" << "Verification" << endl;
+    cout << left << setw(14) << n << setw(12) << fixed << setprecision(1) << mapTime.count()
+         << setw(12) << sortTime.count() << setw(12) << syncTime.count()
+         << setw(16) << setprecision(0) << n / (sortTime.count() / 1000)
+         << setw(12) << setprecision(1) << file.bytes() / 1e6 / (sortTime.count() / 1000)
+         << (sorted && synced ? "Correct" : "Incorrect") << endl;
+    return sorted && synced;
+}
+
+// Usage: key_file_sort <file> [--type int32|int64|uint64|float]
+//        [--engine hybrid-odd-even|hybrid-alternate|std::sort] [--threads n]
+//        [--huge-pages] [--generate keys] [--seed s]
+// Keys are fixed width and native endian; float files must not hold NaN.
+// --generate (re)creates the file with random keys before sorting it.
+int main(int argc, char* argv[]) {
+    KeyFileOptions options = {"", "int32", "hybrid-odd-even", 0, false, -1, 42};
+    bool ok = argc > 1;
+    for (int i = 1; i < argc && ok; i++) {
+        string flag = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if (flag == "--huge-pages") {
+            options.hugePages = true;
+        } else if (flag == "--type" && (value == "int32" || value == "int64" || value == "uint64" || value == "float")) {
+            options.type = value;
+            i++;
+        } else if (flag == "--engine" &&
+                   (value == "hybrid-odd-even" || value == "hybrid-alternate" || value == "std::sort")) {
+            options.engine = value;
+            i++;
+        } else if (flag == "--threads" && !value.empty()) {
+            options.threads = atoi(value.c_str());
+            i++;
+        } else if (flag == "--generate" && !value.empty()) {
+            options.generate = atol(value.c_str());
+            i++;
+        } else if (flag == "--seed" && !value.empty()) {
+            options.seed = strtoul(value.c_str(), nullptr, 10);
+            i++;
+        } else if (flag.compare(0, 2, "--") != 0 && options.path.empty()) {
+            options.path = flag;
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok || options.path.empty()) {
+        cerr << "Usage: " << argv[0] << " <file> [--type int32|int64|uint64|float]"
+             << " [--engine hybrid-odd-even|hybrid-alternate|std::sort] [--threads n]"
+             << " [--huge-pages] [--generate keys] [--seed s]" << endl;
+        return 1;
+    }
+
+    bool sorted;
+    if (options.type == "int64") {
+        sorted = sortKeyFile<int64_t>(options);
+    } else if (options.type == "uint64") {
+        sorted = sortKeyFile<uint64_t>(options);
+    } else if (options.type == "float") {
+        sorted = sortKeyFile<float>(options);
+    } else {
+        sorted = sortKeyFile<int32_t>(options);
+    }
+    return sorted ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include "key_payload_sort.h"
+using namespace std;
+
+// Payload of a fixed number of bytes; the first int repeats the key so the
+// result can be checked
+template <int Bytes>
+struct Payload {
+    char data[Bytes];
+};
+
+// Whole record sorted by key, what the engines would move without the
+// key/index split
+template <int Bytes>
+struct Record {
+    int key;
+    Payload<Bytes> payload;
+
+    bool operator<(const Record& other) const { return key < other.key; }
+};
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+template <int Bytes>
+bool payloadsFollowKeys(const vector<int>& keys, const vector<Payload<Bytes> >& payloads) {
+    for (size_t i = 0; i < keys.size(); i++) {
+        int stored;
+        memcpy(&stored, payloads[i].data, sizeof(stored));
+        if (stored != keys[i] || (i > 0 && keys[i] < keys[i - 1])) return false;
+    }
+    return true;
+}
+
+// One row: whole records through odd-even against the key/index engines
+template <int Bytes>
+void runPayloadSize(const vector<int>& input, WorkerPool& pool) {
+    long n = input.size();
+    vector<Payload<Bytes> > payloads(n);
+    vector<Record<Bytes> > records(n);
+    for (long i = 0; i < n; i++) {
+        memcpy(payloads[i].data, &input[i], sizeof(int));
+        records[i].key = input[i];
+        records[i].payload = payloads[i];
+    }
+
+    double recordTime = oddEvenTranspositionSortWithStats(records, pool, false).milliseconds;
+    bool correct = true;
+    for (long i = 1; i < n; i++) {
+        correct = correct && !(records[i] < records[i - 1]);
+    }
+
+    cout << left << setw(10) << Bytes << setw(18) << fixed << setprecision(3) << recordTime;
+
+    const PayloadEngine engines[] = {PAYLOAD_ODD_EVEN, PAYLOAD_SASAKI, PAYLOAD_ALTERNATE};
+    for (PayloadEngine engine : engines) {
+        vector<int> keys = input;
+        vector<Payload<Bytes> > moved = payloads;
+        double time = sortByKey(keys, moved, pool, engine).milliseconds;
+        correct = correct && payloadsFollowKeys(keys, moved);
+        cout << setw(18) << time;
+    }
+
+    vector<unsigned> permutation;
+    double permutationTime = sortPermutation(input, permutation, pool, PAYLOAD_ODD_EVEN).milliseconds;
+    for (long i = 1; i < n; i++) {
+        correct = correct && input[permutation[i - 1]] <= input[permutation[i]];
+    }
+    cout << setw(18) << permutationTime << (correct ? "Correct" : "Incorrect") << endl;
+}
+
+// Arguments: number of keys (default 5000), pool threads (default: one per core)
+int main(int argc, char* argv[]) {
+    int size = argc > 1 ? atoi(argv[1]) : 5000;
+    int threads = argc > 2 ? atoi(argv[2]) : 0;
+    WorkerPool pool(threads);
+    vector<int> input = generateRandomArray(size);
+
+    cout << "=== Key/Payload Sorting (" << size << " keys, " << pool.size() << " threads, ms) ===" << endl << endl;
+    cout << left << setw(10) << "Payload" << setw(18) << "Records OE"
+         << setw(18) << "Key/Index OE" << setw(18) << "Key/Index Sasaki"
+         << setw(18) << "Key/Index Alt" << setw(18) << "Permutation OE" << "Verification" << endl;
+    cout << string(112, '-') << endl;
+
+    runPayloadSize<16>(input, pool);
+    runPayloadSize<64>(input, pool);
+    runPayloadSize<256>(input, pool);
+    return 0;
+}
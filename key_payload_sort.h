@@ -0,0 +1,97 @@
+#ifndef KEY_PAYLOAD_SORT_H
+#define KEY_PAYLOAD_SORT_H
+
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "alternative_time_optimal_sort.h"
+#include "odd_even_transposition_sort.h"
+#include "sasaki_time_optimal_sort.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Engines that can sort keys with a payload index alongside
+enum PayloadEngine { PAYLOAD_ODD_EVEN, PAYLOAD_SASAKI, PAYLOAD_ALTERNATE };
+
+// Order preserving maps of 32 bit keys to unsigned bits
+inline unsigned orderedBits(int key) {
+    return static_cast<unsigned>(key) ^ 0x80000000u;
+}
+
+inline unsigned orderedBits(unsigned key) {
+    return key;
+}
+
+inline unsigned orderedBits(float key) {
+    unsigned bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    // Negative floats order in reverse, positive ones after all negatives
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// Sorts the keys through one of the engines without touching them and fills
+// permutation so that keys[permutation[i]] is the i-th smallest key. Each key
+// is packed with its index into one 64 bit word: every compare-exchange moves
+// 8 bytes whatever the record size, and equal keys keep their input order.
+template <class Key>
+inline SortStats sortPermutation(const std::vector<Key>& keys, std::vector<unsigned>& permutation,
+                                 WorkerPool& pool, PayloadEngine engine) {
+    static_assert(sizeof(Key) == 4, "keys are packed with a 32 bit index into 64 bits");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = keys.size();
+    std::vector<unsigned long long> packed(n);
+    for (long i = 0; i < n; i++) {
+        packed[i] = static_cast<unsigned long long>(orderedBits(keys[i])) << 32 | static_cast<unsigned>(i);
+    }
+
+    SortStats stats;
+    if (engine == PAYLOAD_SASAKI) {
+        std::vector<unsigned long long> result;
+        stats = sasakiArenaTimeOptimalSortWithStats(packed, result, pool, false);
+        packed.swap(result);
+    } else if (engine == PAYLOAD_ALTERNATE) {
+        stats = alternateTimeOptimalSortingWithStats(packed, pool, false);
+    } else {
+        stats = oddEvenTranspositionSortWithStats(packed, pool, false);
+    }
+
+    permutation.resize(n);
+    for (long i = 0; i < n; i++) {
+        permutation[i] = static_cast<unsigned>(packed[i]);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    stats.milliseconds = duration.count();
+    return stats;
+}
+
+// Sorts keys and their payloads (payloads[i] belongs to keys[i]). The engine
+// only sees the packed keys; every payload is moved exactly once at the end.
+template <class Key, class Payload>
+inline SortStats sortByKey(std::vector<Key>& keys, std::vector<Payload>& payloads,
+                           WorkerPool& pool, PayloadEngine engine) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<unsigned> permutation;
+    SortStats stats = sortPermutation(keys, permutation, pool, engine);
+
+    long n = keys.size();
+    std::vector<Key> sortedKeys(n);
+    std::vector<Payload> sortedPayloads(n);
+    for (long i = 0; i < n; i++) {
+        sortedKeys[i] = keys[permutation[i]];
+        sortedPayloads[i] = std::move(payloads[permutation[i]]);
+    }
+    keys.swap(sortedKeys);
+    payloads.swap(sortedPayloads);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    stats.milliseconds = duration.count();
+    return stats;
+}
+
+#endif
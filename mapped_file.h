@@ -0,0 +1,150 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Asks for transparent huge pages on a mapping; false where the kernel
+// refuses the advice. Accepted advice is no promise for file mappings, which
+// get huge pages only where the file system and its settings allow (tmpfs
+// needs a huge= mount option), so hugePageBytes checks what was granted.
+inline bool adviseHugePages(void* base, size_t bytes) {
+#ifdef MADV_HUGEPAGE
+    return madvise(base, bytes, MADV_HUGEPAGE) == 0;
+#else
+    (void)base;
+    (void)bytes;
+    return false;
+#endif
+}
+
+// Bytes of the mappings overlapping [base, base + bytes) that are backed by
+// huge pages right now, summed from the AnonHugePages, ShmemPmdMapped and
+// FilePmdMapped lines of /proc/self/smaps; -1 where smaps cannot be read
+inline long hugePageBytes(const void* base, size_t bytes) {
+    std::ifstream smaps("/proc/self/smaps");
+    if (!smaps) {
+        return -1;
+    }
+    unsigned long first = reinterpret_cast<unsigned long>(base), last = first + bytes;
+    bool inside = false;
+    long kilobytes = 0;
+    std::string line;
+    while (std::getline(smaps, line)) {
+        unsigned long start, end;
+        char key[64];
+        long value;
+        // Header lines start with the address range of the next mapping
+        if (sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2) {
+            inside = start < last && end > first;
+        } else if (inside && sscanf(line.c_str(), "%63[^:]: %ld kB", key, &value) == 2) {
+            std::string field = key;
+            if (field == "AnonHugePages" || field == "ShmemPmdMapped" || field == "FilePmdMapped") {
+                kilobytes += value;
+            }
+        }
+    }
+    return kilobytes * 1024;
+}
+
+// A whole file mapped shared and writable, so sorting the mapping sorts the
+// file: no parsing, no copy and no separate write. With size >= 0 the file
+// is created or resized to size bytes first. The whole file is prefetched
+// with MADV_WILLNEED, since a sort touches every page.
+class MappedFile {
+public:
+    MappedFile(const std::string& path, long size, bool hugePages)
+        : fd(-1), base(MAP_FAILED), length(0), huge(false) {
+        fd = open(path.c_str(), size >= 0 ? O_RDWR | O_CREAT : O_RDWR, 0644);
+        struct stat info;
+        if (fd < 0 || (size >= 0 && ftruncate(fd, size) != 0) || fstat(fd, &info) != 0) {
+            return;
+        }
+        length = info.st_size;
+        if (length == 0) {
+            return;
+        }
+        base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            return;
+        }
+        madvise(base, length, MADV_WILLNEED);
+        huge = hugePages && adviseHugePages(base, length);
+    }
+
+    ~MappedFile() {
+        if (base != MAP_FAILED) {
+            munmap(base, length);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // An empty file is valid but has no mapping
+    bool valid() const { return fd >= 0 && (length == 0 || base != MAP_FAILED); }
+    size_t bytes() const { return length; }
+    // Whether huge pages were asked for and the advice accepted
+    bool hugePagesAdvised() const { return huge; }
+    // Bytes of the mapping on huge pages at the moment of the call
+    long hugePageBytes() const { return length == 0 ? 0 : ::hugePageBytes(base, length); }
+
+    template <class T>
+    T* data() const { return length == 0 ? nullptr : static_cast<T*>(base); }
+
+    // Writes the dirty pages back and waits for them
+    bool sync() const { return length == 0 || msync(base, length, MS_SYNC) == 0; }
+
+private:
+    int fd;
+    void* base;
+    size_t length;
+    bool huge;
+};
+
+// Anonymous private memory of the given size, optionally on transparent
+// huge pages (which anonymous memory always supports where THP is enabled)
+class MappedBuffer {
+public:
+    MappedBuffer(size_t bytes, bool hugePages) : base(MAP_FAILED), length(bytes), huge(false) {
+        if (length == 0) {
+            return;
+        }
+        base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base != MAP_FAILED) {
+            huge = hugePages && adviseHugePages(base, length);
+        }
+    }
+
+    ~MappedBuffer() {
+        if (base != MAP_FAILED) {
+            munmap(base, length);
+        }
+    }
+
+    MappedBuffer(const MappedBuffer&) = delete;
+    MappedBuffer& operator=(const MappedBuffer&) = delete;
+
+    bool valid() const { return length == 0 || base != MAP_FAILED; }
+    size_t bytes() const { return length; }
+    bool hugePagesAdvised() const { return huge; }
+    long hugePageBytes() const { return length == 0 ? 0 : ::hugePageBytes(base, length); }
+
+    template <class T>
+    T* data() const { return length == 0 ? nullptr : static_cast<T*>(base); }
+
+private:
+    void* base;
+    size_t length;
+    bool huge;
+};
+
+#endif
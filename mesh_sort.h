@@ -0,0 +1,118 @@
+#ifndef MESH_SORT_H
+#define MESH_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <vector>
+#include "odd_even_transposition_sort.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Sorting on a 2D mesh of processes instead of a linear array. The n keys sit
+// on an r x c grid (r = ceil(sqrt(n)), c = ceil(n / r), padded with INT_MAX),
+// one key per process, and every phase sorts all rows or all columns at once
+// by odd-even transposition between mesh neighbours. Rows and columns are
+// independent, so a worker sorts whole rows on its own and the pool barrier
+// only separates the phases.
+
+// Copies the rows x cols matrix src into dst transposed, for the worker's
+// share of the destination rows. Walks 32 x 32 tiles so both sides stay in
+// cache.
+inline void transposeRows(const int* src, int* dst, long rows, long cols, long begin, long end) {
+    const long tile = 32;
+    for (long j0 = begin; j0 < end; j0 += tile) {
+        long j1 = std::min(j0 + tile, end);
+        for (long i0 = 0; i0 < rows; i0 += tile) {
+            long i1 = std::min(i0 + tile, rows);
+            for (long j = j0; j < j1; j++) {
+                for (long i = i0; i < i1; i++) {
+                    dst[j * rows + i] = src[i * cols + j];
+                }
+            }
+        }
+    }
+}
+
+// Shearsort: ceil(log2 r) + 1 row phases in snake order (even rows ascending,
+// odd rows descending) with a column phase after all but the last; reading
+// the grid in snake order gives the sorted keys. Column phases work on a
+// transposed copy of the grid, so a column is contiguous in memory like a
+// row. By the 0-1 principle, iteration t leaves at most ceil(r / 2^t) dirty
+// rows, all adjacent, so column phase t + 1 only needs that many
+// transposition rounds instead of r: O(sqrt(n) log n) rounds in total.
+// Rounds are counted as mesh steps, i.e. the transposition rounds of a phase.
+inline SortStats shearSortWithStats(std::vector<int>& arr, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    long rows = 1;
+    while (rows * rows < n) {
+        rows++;
+    }
+    long cols = n > 0 ? (n + rows - 1) / rows : 0;
+    long iterations = 1;
+    for (long dirty = rows; dirty > 1; dirty = (dirty + 1) / 2) {
+        iterations++;
+    }
+
+    std::vector<int> grid(rows * cols, INT_MAX), columns(rows * cols);
+    std::copy(arr.begin(), arr.end(), grid.begin());
+    long meshSteps = 0;
+
+    pool.run([&](int worker) {
+        long rowBegin, rowEnd, colBegin, colEnd;
+        pool.chunk(rows, worker, rowBegin, rowEnd);
+        pool.chunk(cols, worker, colBegin, colEnd);
+        long dirty = rows;
+
+        for (long t = 1; t <= iterations; t++) {
+            SORT_TRACE_BEGIN("rows", t);
+            for (long i = rowBegin; i < rowEnd; i++) {
+                int* row = grid.data() + i * cols;
+                oddEvenTranspositionSortTile(row, cols);
+                if (i % 2 == 1) {
+                    std::reverse(row, row + cols);
+                }
+            }
+            SORT_TRACE_END("rows", t);
+            pool.barrier(worker);
+            if (worker == 0) {
+                meshSteps += cols;
+            }
+            if (t == iterations) {
+                break;
+            }
+
+            SORT_TRACE_BEGIN("columns", t);
+            transposeRows(grid.data(), columns.data(), rows, cols, colBegin, colEnd);
+            for (long j = colBegin; j < colEnd; j++) {
+                oddEvenTranspositionSortTile(columns.data() + j * rows, rows, dirty);
+            }
+            SORT_TRACE_END("columns", t);
+            pool.barrier(worker);
+            transposeRows(columns.data(), grid.data(), cols, rows, rowBegin, rowEnd);
+            pool.barrier(worker);
+            if (worker == 0) {
+                meshSteps += dirty;
+            }
+            dirty = (dirty + 1) / 2;
+        }
+    });
+
+    for (long k = 0; k < n; k++) {
+        long i = k / cols, j = k % cols;
+        arr[k] = grid[i * cols + (i % 2 == 0 ? j : cols - 1 - j)];
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    SortStats stats = {duration.count(), meshSteps, -1};
+    return stats;
+}
+
+inline double shearSort(std::vector<int>& arr, WorkerPool& pool) {
+    return shearSortWithStats(arr, pool).milliseconds;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include "multi_process_sort.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+void printRow(int size, const MultiProcessReport& report, bool correct) {
+    cout << left << setw(12) << size << setw(14) << fixed << setprecision(3) << report.milliseconds
+         << setw(12) << report.exchanges << setw(20) << report.exchangeMicroseconds
+         << setw(16) << report.megabytesPerSecond
+         << (report.ok && correct ? "Correct" : "Incorrect") << endl;
+}
+
+void printHeader(const string& title, int workers) {
+    cout << "=== " << title << " (" << workers << " processes) ===" << endl;
+    cout << left << setw(12) << "Size" << setw(14) << "Time(ms)" << setw(12) << "Exchanges"
+         << setw(20) << "Exchange(us)" << setw(16) << "Neighbour MB/s" << "Verification" << endl;
+}
+
+// Arguments: number of worker processes (default, or 0: one per core)
+int main(int argc, char* argv[]) {
+    int workers = argc > 1 ? atoi(argv[1]) : 0;
+    if (workers <= 0) {
+        workers = WorkerPool::defaultThreadCount();
+    }
+    vector<int> sizes = {1000, 100000, 1000000, 10000000};
+
+    double latency = 0, rate = 0;
+    bool ok = measureChannel(1000000, latency, rate);
+    cout << "=== Neighbour channel (2 processes) ===" << endl;
+    cout << "One-way latency: " << fixed << setprecision(3) << latency << " us" << endl;
+    cout << "Streaming: " << setprecision(0) << rate << " messages/s"
+         << (ok ? "" : " (failed)") << endl << endl;
+
+    printHeader("Multi-Process Block Odd-Even Transposition Sort", workers);
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> expected = arr;
+        sort(expected.begin(), expected.end());
+        MultiProcessReport report = multiProcessBlockOddEvenSort(arr, workers);
+        printRow(size, report, arr == expected);
+    }
+    cout << endl;
+
+    printHeader("Multi-Process Block Sasaki Sort", workers);
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> expected = arr;
+        sort(expected.begin(), expected.end());
+        vector<int> result;
+        MultiProcessReport report = multiProcessBlockSasakiSort(arr, result, workers);
+        printRow(size, report, result == expected);
+    }
+    cout << endl;
+
+    return 0;
+}
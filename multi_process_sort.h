@@ -0,0 +1,483 @@
+#ifndef MULTI_PROCESS_SORT_H
+#define MULTI_PROCESS_SORT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "odd_even_transposition_sort.h"
+#include "sasaki_time_optimal_sort.h"
+
+// The rings are shared between processes, which needs address-free atomics
+static_assert(ATOMIC_LONG_LOCK_FREE == 2, "unsigned long atomics must be lock-free");
+
+// Anonymous POSIX shared memory segment. The name is unlinked as soon as it is
+// mapped, so the segment is only reachable through the mapping, which forked
+// workers inherit at the same address.
+class SharedSegment {
+public:
+    explicit SharedSegment(size_t bytes) : base(MAP_FAILED), bytes(bytes) {
+        char name[64];
+        snprintf(name, sizeof(name), "/distributed_sort_%d", static_cast<int>(getpid()));
+        int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            return;
+        }
+        shm_unlink(name);
+        if (ftruncate(fd, bytes) == 0) {
+            base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+    }
+
+    ~SharedSegment() {
+        if (base != MAP_FAILED) {
+            munmap(base, bytes);
+        }
+    }
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    bool valid() const { return base != MAP_FAILED; }
+
+    template <class T>
+    T* at(size_t offset) const { return reinterpret_cast<T*>(static_cast<char*>(base) + offset); }
+
+private:
+    void* base;
+    size_t bytes;
+};
+
+// Offsets of the parts of a segment, each on its own cache line
+class SegmentLayout {
+public:
+    SegmentLayout() : total(0) {}
+
+    size_t add(size_t bytes) {
+        size_t offset = (total + 63) / 64 * 64;
+        total = offset + bytes;
+        return offset;
+    }
+
+    size_t size() const { return std::max<size_t>(total, 64); }
+
+private:
+    size_t total;
+};
+
+// Message of a neighbour channel: "round i can start, my block of that round
+// is the length keys at offset of the source buffer". The block itself is
+// never copied; the neighbour merges it straight out of the shared segment.
+struct BlockDescriptor {
+    long round;
+    long offset;
+    long length;
+};
+
+// Lock-free single-producer/single-consumer ring living in shared memory. The
+// producer only writes tail, the consumer only writes head, and the two sit
+// on separate cache lines.
+class SpscRing {
+public:
+    static const unsigned long capacity = 64;
+
+    SpscRing() : head(0), tail(0) {}
+
+    void push(const BlockDescriptor& msg) {
+        unsigned long t = tail.load(std::memory_order_relaxed);
+        int spins = 0;
+        while (t - head.load(std::memory_order_acquire) == capacity) {
+            backOff(spins);
+        }
+        slots[t % capacity] = msg;
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    BlockDescriptor pop() {
+        unsigned long h = head.load(std::memory_order_relaxed);
+        int spins = 0;
+        while (tail.load(std::memory_order_acquire) == h) {
+            backOff(spins);
+        }
+        BlockDescriptor msg = slots[h % capacity];
+        head.store(h + 1, std::memory_order_release);
+        return msg;
+    }
+
+private:
+    // Yield once spinning gets long, so more workers than cores still progress
+    static void backOff(int& spins) {
+        if (++spins > 1024) {
+            std::this_thread::yield();
+        }
+    }
+
+    alignas(64) std::atomic<unsigned long> head;
+    alignas(64) std::atomic<unsigned long> tail;
+    alignas(64) BlockDescriptor slots[capacity];
+};
+
+// Exchange counters a worker leaves in the segment for the launcher
+struct alignas(64) ExchangeStats {
+    long exchanges;
+    double waitSeconds;
+    long neighbourBytes;
+};
+
+// What a multi-process run cost, summed over the workers
+struct MultiProcessReport {
+    double milliseconds;
+    long exchanges;
+    // Mean time from posting a round's descriptors to holding the neighbours' ones
+    double exchangeMicroseconds;
+    // Neighbour block bytes merged in place per second of the run
+    double megabytesPerSecond;
+    bool ok;
+};
+
+// Rings between neighbouring workers: worker w sends to w + 1 through ring
+// 2w + 1 and to w - 1 through ring 2w
+class NeighbourChannels {
+public:
+    NeighbourChannels(SpscRing* rings, int workers) : rings(rings), workers(workers) {
+        for (int r = 0; r < 2 * workers; r++) {
+            new (&rings[r]) SpscRing();
+        }
+    }
+
+    void send(int from, int to, const BlockDescriptor& msg) { rings[2 * from + (to > from ? 1 : 0)].push(msg); }
+
+    BlockDescriptor receive(int from, int to) { return rings[2 * from + (to > from ? 1 : 0)].pop(); }
+
+    // Posts mine to both neighbours and waits for theirs of the same round.
+    // A worker posts round i only after it finished round i - 1, so receiving
+    // round i also means the neighbour is done reading this worker's blocks.
+    void exchange(int worker, const BlockDescriptor& mine, BlockDescriptor& left, BlockDescriptor& right,
+                  ExchangeStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        if (worker > 0) send(worker, worker - 1, mine);
+        if (worker < workers - 1) send(worker, worker + 1, mine);
+        if (worker > 0) left = receive(worker - 1, worker);
+        if (worker < workers - 1) right = receive(worker + 1, worker);
+        std::chrono::duration<double> waited = std::chrono::steady_clock::now() - start;
+        stats.exchanges++;
+        stats.waitSeconds += waited.count();
+    }
+
+private:
+    SpscRing* rings;
+    int workers;
+};
+
+// Forks one process per worker, pinned to core w, runs body(w) in each and
+// waits for all of them. Returns false if a worker could not be started or
+// did not exit cleanly.
+inline bool launchProcesses(int workers, const std::function<void(int)>& body) {
+    std::vector<pid_t> children;
+    bool ok = true;
+    for (int w = 0; w < workers && ok; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            pinThreadToCore(w % WorkerPool::defaultThreadCount());
+            body(w);
+            _exit(0);
+        }
+        if (pid < 0) {
+            // The workers already started would wait forever on their missing
+            // neighbour inside the exchange, so stop them before waiting
+            ok = false;
+            for (pid_t child : children) {
+                kill(child, SIGKILL);
+            }
+        } else {
+            children.push_back(pid);
+        }
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+inline MultiProcessReport summarize(const ExchangeStats* stats, int workers, double milliseconds, bool ok) {
+    MultiProcessReport report = {milliseconds, 0, 0, 0, ok};
+    double waitSeconds = 0;
+    long bytes = 0;
+    for (int w = 0; w < workers; w++) {
+        report.exchanges += stats[w].exchanges;
+        waitSeconds += stats[w].waitSeconds;
+        bytes += stats[w].neighbourBytes;
+    }
+    if (report.exchanges > 0) {
+        report.exchangeMicroseconds = waitSeconds * 1e6 / report.exchanges;
+    }
+    if (milliseconds > 0) {
+        report.megabytesPerSecond = bytes / (milliseconds * 1e3);
+    }
+    return report;
+}
+
+// Block odd-even transposition sort with one OS process per block. Same
+// schedule as blockOddEvenTranspositionSort, with the pool barrier replaced
+// by a descriptor exchange with the two neighbours, and the double buffer in
+// a shared segment so the partner's block is merged in place.
+inline MultiProcessReport multiProcessBlockOddEvenSort(std::vector<int>& arr, int workers) {
+    if (workers < 1) {
+        MultiProcessReport failed = {0, 0, 0, 0, false};
+        return failed;
+    }
+    long n = arr.size();
+    long p = workers;
+    SegmentLayout layout;
+    size_t ringsAt = layout.add(2 * p * sizeof(SpscRing));
+    size_t statsAt = layout.add(p * sizeof(ExchangeStats));
+    size_t buffersAt[2] = {layout.add(n * sizeof(int)), layout.add(n * sizeof(int))};
+    SharedSegment segment(layout.size());
+    if (!segment.valid()) {
+        MultiProcessReport failed = {0, 0, 0, 0, false};
+        return failed;
+    }
+
+    NeighbourChannels channels(segment.at<SpscRing>(ringsAt), workers);
+    ExchangeStats* stats = segment.at<ExchangeStats>(statsAt);
+    std::fill(stats, stats + p, ExchangeStats());
+    int* buffers[2] = {segment.at<int>(buffersAt[0]), segment.at<int>(buffersAt[1])};
+    std::copy(arr.begin(), arr.end(), buffers[0]);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ok = launchProcesses(workers, [&](int worker) {
+        long begin, end;
+        blockRange(n, p, worker, begin, end);
+        std::sort(buffers[0] + begin, buffers[0] + end);
+
+        // For p rounds, odd rounds pair blocks (0,1), (2,3)... even rounds (1,2), (3,4)...
+        for (long i = 1; i <= p; i++) {
+            long srcIndex = (i - 1) % 2;
+            BlockDescriptor mine = {i, static_cast<long>(buffersAt[srcIndex] + begin * sizeof(int)), end - begin};
+            BlockDescriptor left = mine, right = mine;
+            channels.exchange(worker, mine, left, right, stats[worker]);
+
+            const int* src = buffers[srcIndex];
+            int* dst = buffers[i % 2];
+            long first = (i % 2 == 1) ? 0 : 1;
+            bool isLeft = (worker - first) % 2 == 0;
+            long partner = isLeft ? worker + 1 : worker - 1;
+
+            if (worker < first || partner >= p) {
+                std::copy(src + begin, src + end, dst + begin);
+            } else {
+                const BlockDescriptor& block = isLeft ? right : left;
+                const int* theirs = segment.at<int>(block.offset);
+                long lenMine = end - begin;
+                if (isLeft) {
+                    mergeLow(src + begin, lenMine, theirs, block.length, dst + begin, lenMine);
+                } else {
+                    mergeHigh(theirs, block.length, src + begin, lenMine, dst + begin, lenMine);
+                }
+                stats[worker].neighbourBytes += block.length * sizeof(int);
+            }
+        }
+    });
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+
+    // After p rounds the result sits in buffer p % 2
+    std::copy(buffers[p % 2], buffers[p % 2] + n, arr.begin());
+    return summarize(stats, workers, duration.count(), ok);
+}
+
+// Blocked Sasaki sort with one OS process per node, following
+// blockSasakiTimeOptimalSort: the lBlock/rBlock slots of both rounds live in
+// the shared segment, every round starts with a descriptor exchange with both
+// neighbours, and the boundary merge-splits read the neighbour's block in place.
+inline MultiProcessReport multiProcessBlockSasakiSort(std::vector<int>& arr, std::vector<int>& result, int workers) {
+    if (workers < 1) {
+        MultiProcessReport failed = {0, 0, 0, 0, false};
+        return failed;
+    }
+    long n = arr.size();
+    long p = workers;
+    long b = (n + p - 1) / p;
+    SegmentLayout layout;
+    size_t ringsAt = layout.add(2 * p * sizeof(SpscRing));
+    size_t statsAt = layout.add(p * sizeof(ExchangeStats));
+    size_t inputAt = layout.add(n * sizeof(int));
+    size_t resultAt = layout.add(n * sizeof(int));
+    // Slot 2j holds the lBlock of node j, slot 2j + 1 its rBlock
+    size_t valuesAt[2] = {layout.add(2 * p * b * sizeof(int)), layout.add(2 * p * b * sizeof(int))};
+    size_t marksAt[2] = {layout.add(2 * p * b), layout.add(2 * p * b)};
+    SharedSegment segment(layout.size());
+    if (!segment.valid()) {
+        MultiProcessReport failed = {0, 0, 0, 0, false};
+        return failed;
+    }
+
+    NeighbourChannels channels(segment.at<SpscRing>(ringsAt), workers);
+    ExchangeStats* stats = segment.at<ExchangeStats>(statsAt);
+    std::fill(stats, stats + p, ExchangeStats());
+    const int* input = segment.at<int>(inputAt);
+    std::copy(arr.begin(), arr.end(), segment.at<int>(inputAt));
+    int* output = segment.at<int>(resultAt);
+    int* values[2] = {segment.at<int>(valuesAt[0]), segment.at<int>(valuesAt[1])};
+    unsigned char* marks[2] = {segment.at<unsigned char>(marksAt[0]), segment.at<unsigned char>(marksAt[1])};
+
+    auto start = std::chrono::high_resolution_clock::now();
+    bool ok = launchProcesses(workers, [&](int worker) {
+        long j = worker;
+        int* lBlock = values[0] + 2 * j * b;
+        int* rBlock = lBlock + b;
+
+        // Initialization: sorted run padded with INT_MAX, copied to both blocks
+        for (long k = 0; k < b; k++) {
+            lBlock[k] = j * b + k < n ? input[j * b + k] : INT_MAX;
+        }
+        std::sort(lBlock, lBlock + b);
+        std::copy(lBlock, lBlock + b, rBlock);
+        std::fill(marks[0] + 2 * j * b, marks[0] + (2 * j + 2) * b, 0);
+        if (j == 0) {
+            std::fill(marks[0] + b, marks[0] + 2 * b, 1);
+        }
+        if (j == p - 1 && p > 1) {
+            std::fill(marks[0] + 2 * j * b, marks[0] + (2 * j + 1) * b, 1);
+        }
+        // Marked keys to the left of this node's lBlock: the first node's rBlock
+        long area = j == 0 ? 0 : b;
+
+        std::vector<int> tempValues(2 * b);
+        std::vector<unsigned char> tempMarks(2 * b);
+        int* newL = tempValues.data();
+        int* newR = newL + b;
+        unsigned char* newLMarks = tempMarks.data();
+        unsigned char* newRMarks = newLMarks + b;
+
+        // For p - 1 rounds
+        for (long i = 1; i < p; i++) {
+            long srcIndex = (i - 1) % 2;
+            long lSlot = 2 * j * b, rSlot = lSlot + b;
+            BlockDescriptor mine = {i, static_cast<long>(valuesAt[srcIndex] + lSlot * sizeof(int)), 2 * b};
+            BlockDescriptor left = mine, right = mine;
+            channels.exchange(worker, mine, left, right, stats[worker]);
+
+            const int* src = values[srcIndex];
+            const unsigned char* srcMarks = marks[srcIndex];
+            int* dst = values[i % 2];
+            unsigned char* dstMarks = marks[i % 2];
+
+            // Boundary merge-splits with the left neighbour's rBlock and the
+            // right neighbour's lBlock, both read in place
+            if (j > 0) {
+                const int* theirs = segment.at<int>(left.offset) + b;
+                long before = std::count(srcMarks + lSlot, srcMarks + lSlot + b, 1);
+                long after = sasakiMergeHigh(theirs, srcMarks + lSlot - b, src + lSlot, srcMarks + lSlot,
+                                             newL, newLMarks, b);
+                // if marked keys move left, increase the area; if they move right, decrease it
+                area += before - after;
+                stats[worker].neighbourBytes += b * (sizeof(int) + 1);
+            }
+            if (j < p - 1) {
+                const int* theirs = segment.at<int>(right.offset);
+                sasakiMergeLow(src + rSlot, srcMarks + rSlot, theirs, srcMarks + rSlot + b, newR, newRMarks, b);
+                stats[worker].neighbourBytes += b * (sizeof(int) + 1);
+            }
+
+            // Local merge-split between lBlock and rBlock
+            if (j > 0 && j < p - 1) {
+                sasakiMergeLow(newL, newLMarks, newR, newRMarks, dst + lSlot, dstMarks + lSlot, b);
+                sasakiMergeHigh(newL, newLMarks, newR, newRMarks, dst + rSlot, dstMarks + rSlot, b);
+            } else if (j > 0) {
+                std::copy(newL, newL + b, dst + lSlot);
+                std::copy(newLMarks, newLMarks + b, dstMarks + lSlot);
+            } else {
+                std::copy(newR, newR + b, dst + rSlot);
+                std::copy(newRMarks, newRMarks + b, dstMarks + rSlot);
+            }
+        }
+
+        // Get sorted result: live keys before this node and how many were marked
+        const int* last = values[(p - 1) % 2];
+        const unsigned char* lastMarks = marks[(p - 1) % 2];
+        long unmarked = (j == 0 ? 0 : (2 * j - 1) * b) - area;
+        long position = area + unmarked / 2;
+        long from = j == 0 ? b : 0, to = j == p - 1 && p > 1 ? b : 2 * b;
+        for (long k = 2 * j * b + from; k < 2 * j * b + to; k++) {
+            bool emit = lastMarks[k] || unmarked++ % 2 == 1;
+            if (emit && position < n) {
+                output[position] = last[k];
+            }
+            position += emit;
+        }
+    });
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+
+    result.assign(output, output + n);
+    return summarize(stats, workers, duration.count(), ok);
+}
+
+// Raw cost of one neighbour channel between two processes: the one-way
+// latency from round trips, and how many descriptors per second one ring
+// streams. Returns false if the processes could not be run.
+inline bool measureChannel(long messages, double& latencyMicroseconds, double& messagesPerSecond) {
+    SegmentLayout layout;
+    size_t ringsAt = layout.add(4 * sizeof(SpscRing));
+    size_t resultsAt = layout.add(2 * sizeof(double));
+    SharedSegment segment(layout.size());
+    if (!segment.valid()) {
+        return false;
+    }
+    NeighbourChannels channels(segment.at<SpscRing>(ringsAt), 2);
+    double* results = segment.at<double>(resultsAt);
+
+    bool ok = launchProcesses(2, [&](int worker) {
+        BlockDescriptor msg = {0, 0, 0};
+        // Ping-pong: worker 0 sends, worker 1 echoes
+        auto start = std::chrono::steady_clock::now();
+        for (long k = 0; k < messages; k++) {
+            msg.round = k;
+            if (worker == 0) {
+                channels.send(0, 1, msg);
+                channels.receive(1, 0);
+            } else {
+                channels.receive(0, 1);
+                channels.send(1, 0, msg);
+            }
+        }
+        std::chrono::duration<double> pingPong = std::chrono::steady_clock::now() - start;
+
+        // Streaming: worker 0 only sends, worker 1 only receives
+        start = std::chrono::steady_clock::now();
+        for (long k = 0; k < messages; k++) {
+            if (worker == 0) {
+                channels.send(0, 1, msg);
+            } else {
+                channels.receive(0, 1);
+            }
+        }
+        std::chrono::duration<double> streaming = std::chrono::steady_clock::now() - start;
+        if (worker == 0) {
+            results[0] = pingPong.count() * 1e6 / (2.0 * messages);
+        } else {
+            results[1] = messages / streaming.count();
+        }
+    });
+
+    latencyMicroseconds = results[0];
+    messagesPerSecond = results[1];
+    return ok;
+}
+
+#endif
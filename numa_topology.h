@@ -0,0 +1,159 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// NUMA nodes and their CPUs as the kernel lists them under
+// /sys/devices/system/node, restricted to the CPUs this process may run on.
+// Without that directory (or off Linux) every CPU is on node 0.
+struct NumaTopology {
+    // CPUs of every node, ascending
+    std::vector<std::vector<int> > nodeCpus;
+    // Node of every CPU, -1 for CPUs the process may not use
+    std::vector<int> cpuNode;
+    // Kernel id of every node: nodes without usable CPUs are left out and
+    // the rest numbered from 0
+    std::vector<int> kernelIds;
+
+    int nodes() const { return static_cast<int>(nodeCpus.size()); }
+};
+
+// Parses a kernel CPU or node list such as "0-3,8-11"
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> items;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = atoi(range.c_str());
+        int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; cpu++) {
+            items.push_back(cpu);
+        }
+    }
+    return items;
+}
+
+inline std::string readSysFile(const std::string& path) {
+    std::ifstream file(path.c_str());
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+inline NumaTopology readNumaTopology() {
+    NumaTopology topology;
+    int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<bool> allowed;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                allowed.resize(cpu + 1, false);
+                allowed[cpu] = true;
+            }
+        }
+    }
+#endif
+    if (allowed.empty()) {
+        allowed.assign(cpus > 0 ? cpus : 1, true);
+    }
+    topology.cpuNode.assign(allowed.size(), -1);
+
+    std::string base = "/sys/devices/system/node/";
+    for (int node : parseCpuList(readSysFile(base + "online"))) {
+        std::vector<int> members;
+        for (int cpu : parseCpuList(readSysFile(base + "node" + std::to_string(node) + "/cpulist"))) {
+            if (cpu < static_cast<int>(allowed.size()) && allowed[cpu]) {
+                members.push_back(cpu);
+            }
+        }
+        // Memory-only nodes and nodes outside our CPU set get no workers
+        if (!members.empty()) {
+            for (int cpu : members) {
+                topology.cpuNode[cpu] = topology.nodes();
+            }
+            topology.nodeCpus.push_back(members);
+            topology.kernelIds.push_back(node);
+        }
+    }
+    if (topology.nodeCpus.empty()) {
+        topology.nodeCpus.push_back(std::vector<int>());
+        topology.kernelIds.push_back(0);
+        for (int cpu = 0; cpu < static_cast<int>(allowed.size()); cpu++) {
+            if (allowed[cpu]) {
+                topology.nodeCpus[0].push_back(cpu);
+                topology.cpuNode[cpu] = 0;
+            }
+        }
+    }
+    return topology;
+}
+
+// Topology of this machine, read once. The first call must come before any
+// thread narrows its affinity, which the first WorkerPool guarantees.
+inline const NumaTopology& numaTopology() {
+    static const NumaTopology topology = readNumaTopology();
+    return topology;
+}
+
+// CPUs node by node, so consecutive workers (which own consecutive blocks)
+// share a node and only the workers at a node boundary talk across sockets
+inline std::vector<int> numaCoreOrder() {
+    std::vector<int> order;
+    for (const std::vector<int>& cpus : numaTopology().nodeCpus) {
+        order.insert(order.end(), cpus.begin(), cpus.end());
+    }
+    return order;
+}
+
+// Migrates the pages of [data, data + bytes) to a node with move_pages (no
+// libnuma needed). Returns the pages now on that node, or -1 where the call
+// is unavailable. Pages shared with a neighbouring range go wherever the
+// last call sends them.
+inline long movePagesToNode(const void* data, size_t bytes, int node) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    unsigned long first = reinterpret_cast<unsigned long>(data) & ~(pageSize - 1);
+    unsigned long last = reinterpret_cast<unsigned long>(data) + bytes;
+    long count = bytes == 0 ? 0 : (last - first + pageSize - 1) / pageSize;
+    if (count == 0) {
+        return 0;
+    }
+    std::vector<void*> pages(count);
+    std::vector<int> nodes(count, numaTopology().kernelIds[node]);
+    std::vector<int> status(count);
+    for (long k = 0; k < count; k++) {
+        pages[k] = reinterpret_cast<void*>(first + k * pageSize);
+    }
+    // MPOL_MF_MOVE: only pages mapped by this process alone
+    if (syscall(SYS_move_pages, 0, count, pages.data(), nodes.data(), status.data(), 1 << 1) != 0) {
+        return -1;
+    }
+    long moved = 0;
+    for (long k = 0; k < count; k++) {
+        moved += status[k] == nodes[k];
+    }
+    return moved;
+#else
+    (void)data;
+    (void)bytes;
+    (void)node;
+    return -1;
+#endif
+}
+
+#endif
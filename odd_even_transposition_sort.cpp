@@ -1,9 +1,11 @@
 #include <iostream>
+#include <cstdlib>
 #include <thread>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include "odd_even_transposition_sort.h"
 using namespace std;
 // Structure for arguments
 struct Arguments {
@@ -122,7 +124,44 @@ void runOddEvenTranspositionSort() {
 }
 
 
-int main() {
+// Run a worker pool version on each size, checking it against std::sort.
+// sortFn(arr, pool) sorts arr in place and returns the time in ms.
+template <class Sort>
+void runPoolVersion(const string& title, const vector<int>& sizes, WorkerPool& pool, Sort sortFn) {
+    cout << "=== " << title << " ===" << endl;
+    cout << "Size\tTime(ms)\tVerification" << endl;
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> arrCopy = arr;
+        double time = sortFn(arr, pool);
+        bool sorted = isSorted(arr);
+
+        sort(arrCopy.begin(), arrCopy.end());
+        bool correctSort = arr == arrCopy;
+        cout << size << "\t" << time << " ms\t" 
+                  << (sorted && correctSort ? "Correct" : "Incorrect") << endl;
+    }
+    cout << endl;
+}
+
+
+// Optional argument: number of worker pool threads (default: one per core)
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
     runOddEvenTranspositionSort();
+
+    // The pool is created once and reused for every size
+    WorkerPool pool(threads);
+    string threadCount = to_string(pool.size());
+    vector<int> poolSizes = {10, 20, 30, 50, 1000, 10000};
+    vector<int> blockSizes = {1000, 100000, 1000000, 10000000};
+    runPoolVersion("Odd-Even Transposition Sort (worker pool, " + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, WorkerPool& pool) { return oddEvenTranspositionSort(arr, pool); });
+    runPoolVersion("Odd-Even Transposition Sort (" + string(simdLevelName(detectSimdLevel())) + " phase kernel, "
+                   + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, WorkerPool& pool) { return simdOddEvenTranspositionSort(arr, pool); });
+    // The block merge-split version (p blocks of n/p elements) on large sizes
+    runPoolVersion("Block Odd-Even Transposition Sort (" + threadCount + " blocks)", blockSizes, pool,
+                   [](vector<int>& arr, WorkerPool& pool) { return blockOddEvenTranspositionSort(arr, pool); });
     return 0;
 }
\ No newline at end of file
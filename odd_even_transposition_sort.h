@@ -0,0 +1,283 @@
+#ifndef ODD_EVEN_TRANSPOSITION_SORT_H
+#define ODD_EVEN_TRANSPOSITION_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "perf_counters.h"
+#include "simd_kernels.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Branchless compare-exchange of arr[index] and arr[index + 1], returns 1 if
+// the pair was out of order
+template <class T>
+inline int compareExchange(T* arr, long index) {
+    int swapped = arr[index + 1] < arr[index];
+    T lo = std::min(arr[index], arr[index + 1]);
+    T hi = std::max(arr[index], arr[index + 1]);
+    arr[index] = lo;
+    arr[index + 1] = hi;
+    return swapped;
+}
+
+// Odd-even transposition sort on a persistent worker pool. Same n rounds as
+// the thread-per-comparison version, but each worker owns a contiguous chunk
+// of the comparators of a round and the round ends on the pool barrier.
+// In adaptive mode it stops once an odd and an even phase in a row made no
+// exchange, since then every adjacent pair is in order. Works on any type
+// with operator<, e.g. the packed key/index pairs of key_payload_sort.h.
+// A profiler, if given, gets hardware counts per round and worker.
+template <class T>
+inline SortStats oddEvenTranspositionSortWithStats(std::vector<T>& arr, WorkerPool& pool, bool adaptive,
+                                                   RoundProfiler* profiler = nullptr) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    T* data = arr.data();
+    ExchangeCounter counter(pool.size());
+    long executed = 0;
+    if (profiler) profiler->prepare(pool.size(), n);
+
+    pool.run([&](int worker) {
+        if (profiler) profiler->start(worker);
+        long quietPhases = 0;
+        long i = 1;
+        // For n rounds
+        for (; i <= n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            // Odd rounds compare (0,1), (2,3)... even rounds compare (1,2), (3,4)...
+            long first = (i % 2 == 1) ? 0 : 1;
+            long comparators = (n - first) / 2;
+            long begin, end;
+            pool.chunk(comparators, worker, begin, end);
+            long swaps = 0;
+            for (long k = begin; k < end; k++) {
+                swaps += compareExchange(data, first + 2 * k);
+            }
+            counter.record(worker, i, swaps);
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+            if (profiler) profiler->endRound(worker, i);
+
+            if (adaptive) {
+                quietPhases = counter.roundTotal(i) == 0 ? quietPhases + 1 : 0;
+                if (quietPhases == 2) {
+                    i++;
+                    break;
+                }
+            }
+        }
+        if (worker == 0) {
+            executed = i - 1;
+        }
+        if (profiler) profiler->stop(worker, i - 1);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    SortStats stats = {duration.count(), executed, counter.total()};
+    return stats;
+}
+
+inline double oddEvenTranspositionSort(std::vector<int>& arr, WorkerPool& pool) {
+    return oddEvenTranspositionSortWithStats(arr, pool, false).milliseconds;
+}
+
+// Odd-even transposition sort with the SIMD phase kernel: each worker runs
+// the compare-exchanges of its chunk of a phase as one vector pass, using the
+// best of AVX-512, AVX2 and SSE4.1 found through CPUID (or scalar)
+inline double simdOddEvenTranspositionSort(std::vector<int>& arr, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+
+    pool.run([&](int worker) {
+        // For n rounds
+        for (long i = 1; i <= n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            long first = (i % 2 == 1) ? 0 : 1;
+            long comparators = (n - first) / 2;
+            long begin, end;
+            pool.chunk(comparators, worker, begin, end);
+            compareExchangePhase(data + first + 2 * begin, end - begin);
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Compare-exchanges of round i whose lower element lies in [begin, end),
+// with the SIMD phase kernel; begin must not be negative
+inline void compareExchangePhaseRange(int* data, long n, long round, long begin, long end) {
+    long first = (round % 2 == 1) ? 0 : 1;
+    long last = std::min(end, n - 1);
+    // Lowest element of the range with this phase's parity
+    long k = begin + ((begin - first) & 1);
+    if (k < last) {
+        compareExchangePhase(data + k, (last - k + 1) / 2);
+    }
+}
+
+// Odd-even transposition sort without the round barrier. Worker w owns the
+// elements of chunk w for the whole run, and a comparator belongs to the
+// owner of its lower element, so a round only touches the first element of
+// the right neighbour's chunk. Round i + 1 starts once both neighbours have
+// finished round i (NeighbourClock), which covers every element it reads and
+// keeps a neighbour from overwriting one this worker has yet to read. Same
+// n rounds with the SIMD phase kernel; there is no adaptive mode, since no
+// worker ever sees a whole round.
+inline double wavefrontOddEvenTranspositionSort(std::vector<int>& arr, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+    NeighbourClock clock(pool.size());
+
+    pool.run([&](int worker) {
+        long begin, end;
+        pool.chunk(n, worker, begin, end);
+
+        // For n rounds
+        for (long i = 1; i <= n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            clock.waitForNeighbours(worker, i - 1);
+            SORT_TRACE_BEGIN("work", i);
+            compareExchangePhaseRange(data, n, i, begin, end);
+            SORT_TRACE_END("work", i);
+            clock.finish(worker, i);
+            SORT_TRACE_END("round", i);
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Odd-even transposition sort of a small tile on the calling thread, with
+// the SIMD phase kernel. Same n rounds by default; used as the base case of
+// the hybrid sort, where a tile fits in L1 and a barrier would cost more than
+// the whole round. Fewer rounds suffice when only a window of that many keys
+// is out of place (see mesh_sort.h).
+inline void oddEvenTranspositionSortTile(int* data, long n, long rounds = -1) {
+    if (rounds < 0) {
+        rounds = n;
+    }
+    for (long i = 1; i <= rounds; i++) {
+        long first = (i % 2 == 1) ? 0 : 1;
+        compareExchangePhase(data + first, (n - first) / 2);
+    }
+}
+
+// Lower half of the merge-split: the len smallest of the sorted runs a and b
+inline void mergeLow(const int* a, long lenA, const int* b, long lenB, int* out, long len) {
+    long i = 0, j = 0;
+    for (long k = 0; k < len; k++) {
+        if (j >= lenB || (i < lenA && a[i] <= b[j])) {
+            out[k] = a[i++];
+        } else {
+            out[k] = b[j++];
+        }
+    }
+}
+
+// Upper half of the merge-split: the len largest of the sorted runs a and b
+inline void mergeHigh(const int* a, long lenA, const int* b, long lenB, int* out, long len) {
+    long i = lenA - 1, j = lenB - 1;
+    for (long k = len - 1; k >= 0; k--) {
+        if (i < 0 || (j >= 0 && b[j] >= a[i])) {
+            out[k] = b[j--];
+        } else {
+            out[k] = a[i--];
+        }
+    }
+}
+
+// Block w of p blocks of ceil(n / p) elements; only the trailing blocks may be
+// short, which behaves like padding the array with +infinity. Letting the
+// leading blocks be the longer ones instead breaks the p round bound.
+inline void blockRange(long n, long p, long w, long& begin, long& end) {
+    long size = (n + p - 1) / p;
+    begin = std::min(n, w * size);
+    end = std::min(n, begin + size);
+}
+
+// Block odd-even transposition sort: worker w owns the w-th of p contiguous
+// blocks, sorts it locally and then runs p rounds of merge-split with its odd
+// or even neighbour, keeping the lower half on the left and the upper half on
+// the right. Rounds are double buffered, so a worker only ever writes its own
+// block of the destination and the neighbour's block is read-only.
+// On a NUMA machine each block of the input is moved to its worker's node
+// before the clock starts, and the scratch buffer is left untouched until
+// round 1, so every block of it is first touched by its owner. A counter, if
+// given, gets the merge-splits whose partners sit on different nodes.
+inline double blockOddEvenTranspositionSort(std::vector<int>& arr, WorkerPool& pool,
+                                            CrossNodeCounter* crossNode = nullptr) {
+    long n = arr.size();
+    long p = pool.size();
+    placeBlocks(arr.data(), n, pool);
+    if (crossNode) crossNode->reset(p);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<int[]> scratch(new int[n]);
+    int* buffers[2] = {arr.data(), scratch.get()};
+
+    pool.run([&](int worker) {
+        long begin, end;
+        blockRange(n, p, worker, begin, end);
+        std::sort(buffers[0] + begin, buffers[0] + end);
+        pool.barrier(worker);
+
+        // For p rounds, odd rounds pair blocks (0,1), (2,3)... even rounds (1,2), (3,4)...
+        for (long i = 1; i <= p; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            const int* src = buffers[(i - 1) % 2];
+            int* dst = buffers[i % 2];
+            long first = (i % 2 == 1) ? 0 : 1;
+            bool isLeft = (worker - first) % 2 == 0;
+            long partner = isLeft ? worker + 1 : worker - 1;
+
+            if (worker < first || partner >= p) {
+                std::copy(src + begin, src + end, dst + begin);
+            } else {
+                long partnerBegin, partnerEnd;
+                blockRange(n, p, partner, partnerBegin, partnerEnd);
+                const int* mine = src + begin;
+                const int* theirs = src + partnerBegin;
+                long lenMine = end - begin, lenTheirs = partnerEnd - partnerBegin;
+                if (crossNode) crossNode->record(worker, pool.node(worker) != pool.node(partner), lenTheirs);
+                if (isLeft) {
+                    mergeLow(mine, lenMine, theirs, lenTheirs, dst + begin, lenMine);
+                } else {
+                    mergeHigh(theirs, lenTheirs, mine, lenMine, dst + begin, lenMine);
+                }
+            }
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+        }
+
+        // After an odd number of rounds the result sits in the scratch buffer
+        if (p % 2 == 1) {
+            std::copy(buffers[1] + begin, buffers[1] + end, buffers[0] + begin);
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Events read around the round loops
+enum PerfEvent {
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_CONTEXT_SWITCHES,
+    PERF_EVENT_COUNT
+};
+
+inline const char* perfEventName(int event) {
+    switch (event) {
+        case PERF_CYCLES: return "cycles";
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_L1D_MISSES: return "l1d_misses";
+        case PERF_LLC_MISSES: return "llc_misses";
+        case PERF_BRANCH_MISSES: return "branch_misses";
+        default: return "context_switches";
+    }
+}
+
+// One reading of every event; -1 for an event the machine does not expose
+struct PerfSample {
+    long long values[PERF_EVENT_COUNT];
+};
+
+// Counters of the calling thread, opened with perf_event_open and running
+// from construction on. With inherit they also count threads the caller
+// creates afterwards, which are added in once those threads exit. Where an
+// event cannot be opened (no PMU in a VM, perf_event_paranoid, not Linux)
+// its value reads as -1 and the rest keep working. Context switches happen
+// in the kernel, so without kernel counting they come from getrusage.
+class PerfCounters {
+public:
+    explicit PerfCounters(bool inherit = false) : inherit(inherit) {
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            fds[e] = open(e, inherit);
+        }
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            if (fds[e] >= 0) close(fds[e]);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one hardware event could be opened
+    bool available() const {
+        for (int e = 0; e < PERF_CONTEXT_SWITCHES; e++) {
+            if (fds[e] >= 0) return true;
+        }
+        return false;
+    }
+
+    PerfSample read() const {
+        PerfSample sample;
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            sample.values[e] = -1;
+#ifdef __linux__
+            long long value;
+            if (fds[e] >= 0 && ::read(fds[e], &value, sizeof(value)) == sizeof(value)) {
+                sample.values[e] = value;
+            } else if (e == PERF_CONTEXT_SWITCHES) {
+                struct rusage usage;
+                if (getrusage(inherit ? RUSAGE_SELF : RUSAGE_THREAD, &usage) == 0) {
+                    sample.values[e] = usage.ru_nvcsw + usage.ru_nivcsw;
+                }
+            }
+#endif
+        }
+        return sample;
+    }
+
+private:
+    static int open(int event, bool inherit) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.inherit = inherit;
+        switch (event) {
+            case PERF_CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PERF_INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PERF_L1D_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case PERF_LLC_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case PERF_BRANCH_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            default:
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+                break;
+        }
+        // Kernel time is counted where allowed, otherwise user space only
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0 && event != PERF_CONTEXT_SWITCHES) {
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+        return fd;
+#else
+        (void)event;
+        (void)inherit;
+        return -1;
+#endif
+    }
+
+    bool inherit;
+    int fds[PERF_EVENT_COUNT];
+};
+
+// Difference of two readings, -1 where either one is missing
+inline PerfSample perfDelta(const PerfSample& from, const PerfSample& to) {
+    PerfSample delta;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        delta.values[e] = from.values[e] < 0 || to.values[e] < 0 ? -1 : to.values[e] - from.values[e];
+    }
+    return delta;
+}
+
+// Per round and per worker counts of an instrumented engine run. The engine
+// calls prepare() before starting the pool, then every worker calls start()
+// before its first round, endRound() after each round barrier and stop()
+// once done. A round's sample therefore covers its compare-exchanges and the
+// wait on the barrier that ends it.
+class RoundProfiler {
+public:
+    RoundProfiler() : numWorkers(0), recordedRounds(0), counting(false) {}
+
+    void prepare(int workers, long rounds) {
+        numWorkers = workers;
+        recordedRounds = 0;
+        counting = false;
+        counters.clear();
+        counters.resize(workers);
+        last.assign(workers, PerfSample());
+        samples.assign(workers * rounds, PerfSample());
+    }
+
+    // Counters are per thread, so each worker opens its own
+    void start(int worker) {
+        counters[worker].reset(new PerfCounters());
+        last[worker] = counters[worker]->read();
+        if (worker == 0) {
+            counting = counters[worker]->available();
+        }
+    }
+
+    void endRound(int worker, long round) {
+        PerfSample now = counters[worker]->read();
+        samples[(round - 1) * numWorkers + worker] = perfDelta(last[worker], now);
+        last[worker] = now;
+    }
+
+    // Worker 0 also records how many rounds were run (fewer when adaptive)
+    void stop(int worker, long executed) {
+        counters[worker].reset();
+        if (worker == 0) {
+            recordedRounds = executed;
+        }
+    }
+
+    int workers() const { return numWorkers; }
+    long rounds() const { return recordedRounds; }
+    // False when no event could be opened at all
+    bool available() const { return counting; }
+
+    const PerfSample& sample(long round, int worker) const { return samples[(round - 1) * numWorkers + worker]; }
+
+    // Sum over the workers of one round
+    PerfSample roundTotal(long round) const { return total(round, round, 0, numWorkers); }
+
+    // Sum over the rounds of one worker
+    PerfSample workerTotal(int worker) const { return total(1, recordedRounds, worker, worker + 1); }
+
+    // One CSV row per round and worker, prefixed with the engine name
+    void writeCsv(std::ostream& out, const std::string& engine) const {
+        for (long round = 1; round <= recordedRounds; round++) {
+            for (int worker = 0; worker < numWorkers; worker++) {
+                out << engine << "," << round << "," << worker;
+                for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                    out << "," << sample(round, worker).values[e];
+                }
+                out << "\n";
+            }
+        }
+    }
+
+    static void writeCsvHeader(std::ostream& out) {
+        out << "engine,round,worker";
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            out << "," << perfEventName(e);
+        }
+        out << "\n";
+    }
+
+private:
+    PerfSample total(long firstRound, long lastRound, int firstWorker, int lastWorker) const {
+        PerfSample sum;
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            sum.values[e] = 0;
+            for (long round = firstRound; round <= lastRound; round++) {
+                for (int worker = firstWorker; worker < lastWorker; worker++) {
+                    long long value = sample(round, worker).values[e];
+                    sum.values[e] = value < 0 || sum.values[e] < 0 ? -1 : sum.values[e] + value;
+                }
+            }
+        }
+        return sum;
+    }
+
+    int numWorkers;
+    long recordedRounds;
+    bool counting;
+    std::vector<std::unique_ptr<PerfCounters> > counters;
+    std::vector<PerfSample> last;
+    std::vector<PerfSample> samples;
+};
+
+#endif
@@ -1,10 +1,12 @@
 #include <iostream>
+#include <cstdlib>
 #include <thread>
 #include <vector>
 #include <climits>
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include "sasaki_time_optimal_sort.h"
 using namespace std;
 // Structure to store the number value and whether it is marked
 struct Element {
@@ -237,7 +239,51 @@ void runSasakiTimeOptimalSort() {
 }
 
 
-int main() {
+// Run a worker pool version on each size, checking it against std::sort.
+// sortFn(arr, result, pool) writes the sorted keys to result and returns the
+// time in ms.
+template <class Sort>
+void runPoolVersion(const string& title, const vector<int>& sizes, WorkerPool& pool, Sort sortFn) {
+    cout << "=== " << title << " ===" << endl;
+    cout << "Size\tTime(ms)\tVerification" << endl;
+    for (int size : sizes) {
+        vector<int> arr = generateRandomArray(size);
+        vector<int> arrCopy = arr;
+        vector<int> result;
+        double time = sortFn(arr, result, pool);
+        bool sorted = isSorted(result);
+
+        sort(arrCopy.begin(), arrCopy.end());
+        bool correctSort = result == arrCopy;
+        cout << size << "\t" << time << " ms\t" 
+                  << (sorted && correctSort ? "Correct" : "Incorrect") << endl;
+    }
+    cout << endl;
+}
+
+
+// Optional argument: number of worker pool threads (default: one per core)
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 0;
     runSasakiTimeOptimalSort();
+
+    // The pool is created once and reused for every size
+    WorkerPool pool(threads);
+    string threadCount = to_string(pool.size());
+    vector<int> poolSizes = {10, 20, 30, 50, 1000, 10000};
+    vector<int> blockSizes = {1000, 100000, 1000000, 10000000};
+    runPoolVersion("Sasaki Time Optimal Sort (worker pool, " + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, vector<int>& result, WorkerPool& pool) {
+                       return sasakiTimeOptimalSort(arr, result, pool);
+                   });
+    runPoolVersion("Sasaki Time Optimal Sort (struct-of-arrays arena, " + threadCount + " threads)", poolSizes, pool,
+                   [](vector<int>& arr, vector<int>& result, WorkerPool& pool) {
+                       return sasakiArenaTimeOptimalSort(arr, result, pool);
+                   });
+    // The blocked version (one sorted block of n/p keys per process node)
+    runPoolVersion("Block Sasaki Time Optimal Sort (" + threadCount + " process nodes)", blockSizes, pool,
+                   [](vector<int>& arr, vector<int>& result, WorkerPool& pool) {
+                       return blockSasakiTimeOptimalSort(arr, result, pool);
+                   });
     return 0;
 }
\ No newline at end of file
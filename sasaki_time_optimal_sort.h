@@ -0,0 +1,520 @@
+#ifndef SASAKI_TIME_OPTIMAL_SORT_H
+#define SASAKI_TIME_OPTIMAL_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "perf_counters.h"
+#include "sort_stats.h"
+#include "worker_pool.h"
+
+// Process node kept by value in one contiguous vector instead of a linked list
+struct SasakiNode {
+    int lValue, rValue;
+    bool lMarked, rMarked;
+    int area;
+};
+
+// Builds the n process nodes with the same values, marks and areas as the
+// linked list version: sentinels at both ends, both copies in the middle
+inline std::vector<SasakiNode> buildSasakiNodes(const std::vector<int>& arr) {
+    long n = arr.size();
+    std::vector<SasakiNode> nodes(n);
+    for (long i = 0; i < n; i++) {
+        SasakiNode& node = nodes[i];
+        if (i == 0) {
+            node = {INT_MIN, arr[i], false, true, -1};
+        } else if (i == n - 1) {
+            node = {arr[i], INT_MAX, true, false, 0};
+        } else {
+            node = {arr[i], arr[i], false, false, 0};
+        }
+    }
+    return nodes;
+}
+
+// Exchange across the boundary between nodes[j - 1] and nodes[j]; only the
+// right-hand node's area changes, so each boundary has a single owner
+inline void sasakiBoundaryExchange(SasakiNode* nodes, long j) {
+    SasakiNode& left = nodes[j - 1];
+    SasakiNode& node = nodes[j];
+    if (left.rValue > node.lValue) {
+        // if marked element moves left, increase the area of the next one
+        // if marked element moves right, decrease the area of the next one
+        if (left.rMarked) {
+            node.area--;
+        }
+        if (node.lMarked) {
+            node.area++;
+        }
+        std::swap(left.rValue, node.lValue);
+        std::swap(left.rMarked, node.lMarked);
+    }
+}
+
+// Local compare of the two values held by one node
+inline void sasakiLocalExchange(SasakiNode* nodes, long j) {
+    SasakiNode& node = nodes[j];
+    if (node.lValue > node.rValue) {
+        std::swap(node.lValue, node.rValue);
+        std::swap(node.lMarked, node.rMarked);
+    }
+}
+
+// Sasaki's time optimal sort on a persistent worker pool. Every round is two
+// phases separated by the pool barrier: all boundary exchanges, then all local
+// exchanges, so no two workers ever touch the same value in the same phase.
+inline double sasakiTimeOptimalSort(std::vector<int>& arr, std::vector<int>& result, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    std::vector<SasakiNode> nodeList = buildSasakiNodes(arr);
+    SasakiNode* nodes = nodeList.data();
+
+    pool.run([&](int worker) {
+        long begin, end;
+        // For n - 1 rounds
+        for (long i = 1; i < n; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("boundary", i);
+            pool.chunk(n - 1, worker, begin, end);
+            for (long j = begin + 1; j < end + 1; j++) {
+                sasakiBoundaryExchange(nodes, j);
+            }
+            SORT_TRACE_END("boundary", i);
+            pool.barrier(worker);
+
+            SORT_TRACE_BEGIN("local", i);
+            pool.chunk(n, worker, begin, end);
+            for (long j = begin; j < end; j++) {
+                sasakiLocalExchange(nodes, j);
+            }
+            SORT_TRACE_END("local", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+        }
+    });
+
+    // Get sorted result according to the rule based on area
+    result.resize(n);
+    for (long j = 0; j < n; j++) {
+        result[j] = nodes[j].area == -1 ? nodes[j].rValue : nodes[j].lValue;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// State of all n process nodes in one round, as separate contiguous arrays.
+// marks holds the lValue mark in bit 0 and the rValue mark in bit 1.
+template <class T>
+struct SasakiRound {
+    T* lValue;
+    T* rValue;
+    int* area;
+    unsigned char* marks;
+};
+
+// Two rounds of struct-of-arrays node state carved out of a single allocation
+template <class T>
+class SasakiArena {
+public:
+    explicit SasakiArena(long n) {
+        // Keep every array on its own 64 byte boundary relative to the arena
+        long stride = (n + 63) / 64 * 64;
+        long roundBytes = stride * (2 * sizeof(T) + sizeof(int) + 1);
+        storage.resize(2 * roundBytes);
+        char* next = storage.data();
+        for (int r = 0; r < 2; r++) {
+            rounds[r].lValue = reinterpret_cast<T*>(next);
+            rounds[r].rValue = reinterpret_cast<T*>(next + stride * sizeof(T));
+            rounds[r].area = reinterpret_cast<int*>(next + 2 * stride * sizeof(T));
+            rounds[r].marks = reinterpret_cast<unsigned char*>(next + stride * (2 * sizeof(T) + sizeof(int)));
+            next += roundBytes;
+        }
+    }
+
+    SasakiRound<T> rounds[2];
+
+private:
+    std::vector<char> storage;
+};
+
+// One full round for node j: boundary exchanges with both neighbours followed
+// by the local exchange, read from round cur and written to round nxt only.
+// Returns the exchanges made; a boundary is counted by its right-hand node.
+template <class T>
+inline int sasakiRoundStep(const SasakiRound<T>& cur, const SasakiRound<T>& nxt, long n, long j) {
+    T l = cur.lValue[j], r = cur.rValue[j];
+    int area = cur.area[j];
+    unsigned char lMark = cur.marks[j] & 1, rMark = cur.marks[j] >> 1;
+    int swaps = 0;
+
+    if (j > 0 && l < cur.rValue[j - 1]) {
+        unsigned char leftMark = cur.marks[j - 1] >> 1;
+        // if marked element moves left, increase the area of the next one
+        // if marked element moves right, decrease the area of the next one
+        area += lMark - leftMark;
+        l = cur.rValue[j - 1];
+        lMark = leftMark;
+        swaps++;
+    }
+    if (j < n - 1 && cur.lValue[j + 1] < r) {
+        r = cur.lValue[j + 1];
+        rMark = cur.marks[j + 1] & 1;
+    }
+    if (r < l) {
+        std::swap(l, r);
+        std::swap(lMark, rMark);
+        swaps++;
+    }
+
+    nxt.lValue[j] = l;
+    nxt.rValue[j] = r;
+    nxt.area[j] = area;
+    nxt.marks[j] = lMark | (rMark << 1);
+    return swaps;
+}
+
+// Branchless form of sasakiRoundStep for interior nodes, which have both
+// neighbours. Rounds never alias, and restrict parameters let it vectorize.
+template <class T>
+inline long sasakiInteriorRange(const T* __restrict curL, const T* __restrict curR,
+                                const int* __restrict curArea, const unsigned char* __restrict curMarks,
+                                T* __restrict nxtL, T* __restrict nxtR,
+                                int* __restrict nxtArea, unsigned char* __restrict nxtMarks,
+                                long first, long last) {
+    long swaps = 0;
+    for (long j = first; j < last; j++) {
+        T l = curL[j], r = curR[j];
+        int marks = curMarks[j];
+        int lMark = marks & 1, rMark = marks >> 1;
+        T leftValue = curR[j - 1], rightValue = curL[j + 1];
+        int leftMark = curMarks[j - 1] >> 1, rightMark = curMarks[j + 1] & 1;
+
+        // All selects are masks (0 or -1) so the loop stays free of branches
+        int fromLeft = -(l < leftValue);
+        int fromRight = -(rightValue < r);
+        lMark ^= (lMark ^ leftMark) & fromLeft;
+        rMark ^= (rMark ^ rightMark) & fromRight;
+        l = std::max(l, leftValue);
+        r = std::min(r, rightValue);
+
+        int local = r < l;
+        int flip = (lMark ^ rMark) & -local;
+        swaps += local - fromLeft;
+        nxtL[j] = std::min(l, r);
+        nxtR[j] = std::max(l, r);
+        nxtArea[j] = curArea[j] + (fromLeft & ((marks & 1) - leftMark));
+        nxtMarks[j] = static_cast<unsigned char>((lMark ^ flip) | ((rMark ^ flip) << 1));
+    }
+    return swaps;
+}
+
+// Rounds nodes [begin, end): the two end nodes take the general step, the
+// interior goes through the vectorizable kernel. Returns the exchanges made.
+template <class T>
+inline long sasakiRoundRange(const SasakiRound<T>& cur, const SasakiRound<T>& nxt, long n, long begin, long end) {
+    long swaps = 0;
+    // Workers past the last node get an empty range at n and must not step it
+    if (begin >= end) {
+        return 0;
+    }
+    if (begin == 0) {
+        swaps += sasakiRoundStep(cur, nxt, n, 0);
+    }
+    long first = std::max(begin, 1L), last = std::min(end, n - 1);
+    if (first < last) {
+        swaps += sasakiInteriorRange(cur.lValue, cur.rValue, cur.area, cur.marks,
+                                     nxt.lValue, nxt.rValue, nxt.area, nxt.marks, first, last);
+    }
+    if (end == n && n > 1) {
+        swaps += sasakiRoundStep(cur, nxt, n, n - 1);
+    }
+    return swaps;
+}
+
+// Sasaki's time optimal sort over a struct-of-arrays arena. Each round reads
+// round r and writes round r + 1, so a node can read its neighbours without
+// locks or a separate boundary phase: one barrier per round, and every
+// round streams the arrays sequentially instead of chasing node pointers.
+// In adaptive mode it stops after a full round without an exchange, which
+// leaves every node unchanged and so can never be followed by another one.
+// The sentinels are the lowest and highest values of T. A profiler, if
+// given, gets hardware counts per round and worker.
+template <class T>
+inline SortStats sasakiArenaTimeOptimalSortWithStats(std::vector<T>& arr, std::vector<T>& result,
+                                                     WorkerPool& pool, bool adaptive,
+                                                     RoundProfiler* profiler = nullptr) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    long rounds = n > 0 ? n - 1 : 0;
+    SasakiArena<T> arena(n);
+    ExchangeCounter counter(pool.size());
+    long executed = 0;
+    result.resize(n);
+    if (profiler) profiler->prepare(pool.size(), rounds);
+
+    pool.run([&](int worker) {
+        long begin, end;
+        pool.chunk(n, worker, begin, end);
+
+        // Initialization of the process nodes owned by this worker
+        SasakiRound<T>& init = arena.rounds[0];
+        for (long j = begin; j < end; j++) {
+            init.lValue[j] = j == 0 ? std::numeric_limits<T>::lowest() : arr[j];
+            init.rValue[j] = j == 0 ? arr[j] : (j == n - 1 ? std::numeric_limits<T>::max() : arr[j]);
+            init.area[j] = j == 0 ? -1 : 0;
+            init.marks[j] = j == 0 ? 2 : (j == n - 1 ? 1 : 0);
+        }
+        pool.barrier(worker);
+        if (profiler) profiler->start(worker);
+
+        // For n - 1 rounds
+        long i = 1;
+        for (; i <= rounds; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            const SasakiRound<T>& cur = arena.rounds[(i - 1) % 2];
+            const SasakiRound<T>& nxt = arena.rounds[i % 2];
+            counter.record(worker, i, sasakiRoundRange(cur, nxt, n, begin, end));
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+            if (profiler) profiler->endRound(worker, i);
+
+            if (adaptive && counter.roundTotal(i) == 0) {
+                i++;
+                break;
+            }
+        }
+        if (worker == 0) {
+            executed = i - 1;
+        }
+        if (profiler) profiler->stop(worker, i - 1);
+
+        // Get sorted result according to the rule based on area
+        const SasakiRound<T>& last = arena.rounds[(i - 1) % 2];
+        for (long j = begin; j < end; j++) {
+            result[j] = last.area[j] == -1 ? last.rValue[j] : last.lValue[j];
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    SortStats stats = {duration.count(), executed, counter.total()};
+    return stats;
+}
+
+inline double sasakiArenaTimeOptimalSort(std::vector<int>& arr, std::vector<int>& result, WorkerPool& pool) {
+    return sasakiArenaTimeOptimalSortWithStats(arr, result, pool, false).milliseconds;
+}
+
+// Sasaki's time optimal sort over the arena without the round barrier. A
+// node reads only its neighbours of the previous round, so round i + 1 of a
+// chunk may start as soon as both neighbouring chunks have finished round i
+// (NeighbourClock). The same wait also protects the double buffer: writing
+// round i + 2 into the slot of round i cannot begin before the neighbours
+// have finished round i + 1, the last one to read it. Initialization counts
+// as round 0. Same n - 1 rounds, no adaptive mode.
+inline double wavefrontSasakiTimeOptimalSort(std::vector<int>& arr, std::vector<int>& result, WorkerPool& pool) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    long rounds = n > 0 ? n - 1 : 0;
+    SasakiArena<int> arena(n);
+    NeighbourClock clock(pool.size(), -1);
+    result.resize(n);
+
+    pool.run([&](int worker) {
+        long begin, end;
+        pool.chunk(n, worker, begin, end);
+
+        // Initialization of the process nodes owned by this worker
+        SasakiRound<int>& init = arena.rounds[0];
+        for (long j = begin; j < end; j++) {
+            init.lValue[j] = j == 0 ? std::numeric_limits<int>::lowest() : arr[j];
+            init.rValue[j] = j == 0 ? arr[j] : (j == n - 1 ? std::numeric_limits<int>::max() : arr[j]);
+            init.area[j] = j == 0 ? -1 : 0;
+            init.marks[j] = j == 0 ? 2 : (j == n - 1 ? 1 : 0);
+        }
+        clock.finish(worker, 0);
+
+        // For n - 1 rounds
+        for (long i = 1; i <= rounds; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            clock.waitForNeighbours(worker, i - 1);
+            SORT_TRACE_BEGIN("work", i);
+            sasakiRoundRange(arena.rounds[(i - 1) % 2], arena.rounds[i % 2], n, begin, end);
+            SORT_TRACE_END("work", i);
+            clock.finish(worker, i);
+            SORT_TRACE_END("round", i);
+        }
+
+        // Get sorted result according to the rule based on area
+        const SasakiRound<int>& last = arena.rounds[rounds % 2];
+        for (long j = begin; j < end; j++) {
+            result[j] = last.area[j] == -1 ? last.rValue[j] : last.lValue[j];
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Lower half of the merge-split of two sorted runs of len keys each, carrying
+// the mark of every key along. Returns how many marked keys ended up in out.
+inline long sasakiMergeLow(const int* a, const unsigned char* aMarks, const int* b, const unsigned char* bMarks,
+                           int* out, unsigned char* outMarks, long len) {
+    long i = 0, j = 0, marked = 0;
+    for (long k = 0; k < len; k++) {
+        bool takeA = j >= len || (i < len && a[i] <= b[j]);
+        out[k] = takeA ? a[i] : b[j];
+        outMarks[k] = takeA ? aMarks[i++] : bMarks[j++];
+        marked += outMarks[k];
+    }
+    return marked;
+}
+
+// Upper half of the same merge-split, filled from the top
+inline long sasakiMergeHigh(const int* a, const unsigned char* aMarks, const int* b, const unsigned char* bMarks,
+                            int* out, unsigned char* outMarks, long len) {
+    long i = len - 1, j = len - 1, marked = 0;
+    for (long k = len - 1; k >= 0; k--) {
+        bool takeB = i < 0 || (j >= 0 && b[j] >= a[i]);
+        out[k] = takeB ? b[j] : a[i];
+        outMarks[k] = takeB ? bMarks[j--] : aMarks[i--];
+        marked += outMarks[k];
+    }
+    return marked;
+}
+
+// Blocked Sasaki sort: p process nodes (one per pool worker), each holding a
+// sorted lBlock and rBlock of b = ceil(n / p) keys. As in the element version
+// the middle nodes start with two copies of their run, the first node's rBlock
+// and the last node's lBlock are marked, and the -inf/+inf sentinel blocks
+// never move, so they are not stored. A round is a boundary merge-split with
+// each neighbour followed by the local merge-split of lBlock and rBlock; after
+// p - 1 rounds the 2p - 2 live blocks are sorted. area counts the marked keys
+// that crossed a node's left boundary, which gives every node its rank offset
+// locally: it emits each marked key and every second unmarked copy.
+// As in the block odd-even sort, the input blocks are moved to their
+// workers' nodes before the clock starts, the node buffers are first touched
+// by their owners, and a counter, if given, gets the boundary merge-splits
+// between nodes on different sockets.
+inline double blockSasakiTimeOptimalSort(std::vector<int>& arr, std::vector<int>& result, WorkerPool& pool,
+                                         CrossNodeCounter* crossNode = nullptr) {
+    long n = arr.size();
+    long p = pool.size();
+    long b = (n + p - 1) / p;
+    placeBlocks(arr.data(), n, pool);
+    if (crossNode) crossNode->reset(p);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    // Slot 2j holds the lBlock of node j, slot 2j + 1 its rBlock. Slots are
+    // written by their node only, starting with round 0 and round 1.
+    std::unique_ptr<int[]> values[2] = {std::unique_ptr<int[]>(new int[2 * p * b]),
+                                        std::unique_ptr<int[]>(new int[2 * p * b])};
+    std::unique_ptr<unsigned char[]> marks[2] = {std::unique_ptr<unsigned char[]>(new unsigned char[2 * p * b]),
+                                                 std::unique_ptr<unsigned char[]>(new unsigned char[2 * p * b])};
+    std::vector<long> area(p);
+    result.resize(n);
+
+    pool.run([&](int worker) {
+        long j = worker;
+        int* lBlock = values[0].get() + 2 * j * b;
+        int* rBlock = lBlock + b;
+
+        // Initialization: sorted run padded with INT_MAX, copied to both blocks
+        for (long k = 0; k < b; k++) {
+            lBlock[k] = j * b + k < n ? arr[j * b + k] : INT_MAX;
+        }
+        std::sort(lBlock, lBlock + b);
+        std::copy(lBlock, lBlock + b, rBlock);
+        std::fill(marks[0].get() + 2 * j * b, marks[0].get() + (2 * j + 2) * b, 0);
+        if (j == 0) {
+            std::fill(marks[0].get() + b, marks[0].get() + 2 * b, 1);
+        }
+        if (j == p - 1 && p > 1) {
+            std::fill(marks[0].get() + 2 * j * b, marks[0].get() + (2 * j + 1) * b, 1);
+        }
+        // Marked keys to the left of this node's lBlock: the first node's rBlock
+        area[j] = j == 0 ? 0 : b;
+
+        std::vector<int> tempValues(2 * b);
+        std::vector<unsigned char> tempMarks(2 * b);
+        int* newL = tempValues.data();
+        int* newR = newL + b;
+        unsigned char* newLMarks = tempMarks.data();
+        unsigned char* newRMarks = newLMarks + b;
+        pool.barrier(worker);
+
+        // For p - 1 rounds
+        for (long i = 1; i < p; i++) {
+            SORT_TRACE_BEGIN("round", i);
+            SORT_TRACE_BEGIN("work", i);
+            const int* src = values[(i - 1) % 2].get();
+            const unsigned char* srcMarks = marks[(i - 1) % 2].get();
+            int* dst = values[i % 2].get();
+            unsigned char* dstMarks = marks[i % 2].get();
+            long lSlot = 2 * j * b, rSlot = lSlot + b;
+
+            // Boundary merge-splits with the left and right neighbours
+            if (crossNode && j > 0) crossNode->record(worker, pool.node(worker) != pool.node(worker - 1), b);
+            if (crossNode && j < p - 1) crossNode->record(worker, pool.node(worker) != pool.node(worker + 1), b);
+            if (j > 0) {
+                long before = std::count(srcMarks + lSlot, srcMarks + lSlot + b, 1);
+                long after = sasakiMergeHigh(src + lSlot - b, srcMarks + lSlot - b, src + lSlot, srcMarks + lSlot,
+                                             newL, newLMarks, b);
+                // if marked keys move left, increase the area; if they move right, decrease it
+                area[j] += before - after;
+            }
+            if (j < p - 1) {
+                sasakiMergeLow(src + rSlot, srcMarks + rSlot, src + rSlot + b, srcMarks + rSlot + b,
+                               newR, newRMarks, b);
+            }
+
+            // Local merge-split between lBlock and rBlock
+            if (j > 0 && j < p - 1) {
+                sasakiMergeLow(newL, newLMarks, newR, newRMarks, dst + lSlot, dstMarks + lSlot, b);
+                sasakiMergeHigh(newL, newLMarks, newR, newRMarks, dst + rSlot, dstMarks + rSlot, b);
+            } else if (j > 0) {
+                std::copy(newL, newL + b, dst + lSlot);
+                std::copy(newLMarks, newLMarks + b, dstMarks + lSlot);
+            } else {
+                std::copy(newR, newR + b, dst + rSlot);
+                std::copy(newRMarks, newRMarks + b, dstMarks + rSlot);
+            }
+            SORT_TRACE_END("work", i);
+            pool.barrier(worker);
+            SORT_TRACE_END("round", i);
+        }
+
+        // Get sorted result: live keys before this node and how many were marked
+        const int* last = values[(p - 1) % 2].get();
+        const unsigned char* lastMarks = marks[(p - 1) % 2].get();
+        long marked = area[j];
+        long unmarked = (j == 0 ? 0 : (2 * j - 1) * b) - marked;
+        long position = marked + unmarked / 2;
+        long from = j == 0 ? b : 0, to = j == p - 1 && p > 1 ? b : 2 * b;
+        for (long k = 2 * j * b + from; k < 2 * j * b + to; k++) {
+            bool emit = lastMarks[k] || unmarked++ % 2 == 1;
+            if (emit && position < n) {
+                result[position] = last[k];
+            }
+            position += emit;
+        }
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// Instruction sets the kernels can run on, best last
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE41, SIMD_AVX2, SIMD_AVX512 };
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX512: return "AVX-512";
+        case SIMD_AVX2: return "AVX2";
+        case SIMD_SSE41: return "SSE4.1";
+        default: return "Scalar";
+    }
+}
+
+// Best instruction set of the running CPU, read once through CPUID
+inline SimdLevel detectSimdLevel() {
+#ifdef SIMD_KERNELS_X86
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SIMD_AVX512
+                                 : __builtin_cpu_supports("avx2") ? SIMD_AVX2
+                                 : __builtin_cpu_supports("sse4.1") ? SIMD_SSE41
+                                 : SIMD_SCALAR;
+    return level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// ----- Odd/even phase kernels -----
+// Compare-exchange of the pairs (0,1), (2,3)... of count pairs starting at arr.
+// The vector versions swap neighbouring lanes, take min and max, and blend the
+// min into even lanes and the max into odd lanes: no branches, and one vector
+// handles 2, 4 or 8 pairs.
+
+inline void compareExchangePhaseScalar(int* arr, long count) {
+    for (long k = 0; k < count; k++) {
+        int lo = std::min(arr[2 * k], arr[2 * k + 1]);
+        int hi = std::max(arr[2 * k], arr[2 * k + 1]);
+        arr[2 * k] = lo;
+        arr[2 * k + 1] = hi;
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+__attribute__((target("sse4.1")))
+inline void compareExchangePhaseSSE41(int* arr, long count) {
+    long k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i*>(arr + 2 * k));
+        __m128i swapped = _mm_shuffle_epi32(v, 0xB1);
+        __m128i lo = _mm_min_epi32(v, swapped);
+        __m128i hi = _mm_max_epi32(v, swapped);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(arr + 2 * k), _mm_blend_epi16(lo, hi, 0xCC));
+    }
+    compareExchangePhaseScalar(arr + 2 * k, count - k);
+}
+
+__attribute__((target("avx2")))
+inline void compareExchangePhaseAVX2(int* arr, long count) {
+    long k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i*>(arr + 2 * k));
+        __m256i swapped = _mm256_shuffle_epi32(v, 0xB1);
+        __m256i lo = _mm256_min_epi32(v, swapped);
+        __m256i hi = _mm256_max_epi32(v, swapped);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(arr + 2 * k), _mm256_blend_epi32(lo, hi, 0xAA));
+    }
+    compareExchangePhaseScalar(arr + 2 * k, count - k);
+}
+
+// GCC 12 flags the undefined passthrough operand inside the AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+inline void compareExchangePhaseAVX512(int* arr, long count) {
+    long k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512i v = _mm512_loadu_si512(arr + 2 * k);
+        __m512i swapped = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
+        __m512i lo = _mm512_min_epi32(v, swapped);
+        __m512i hi = _mm512_max_epi32(v, swapped);
+        _mm512_storeu_si512(arr + 2 * k, _mm512_mask_blend_epi32(0xAAAA, lo, hi));
+    }
+    compareExchangePhaseScalar(arr + 2 * k, count - k);
+}
+#pragma GCC diagnostic pop
+#endif
+
+typedef void (*PhaseKernel)(int*, long);
+
+// Phase kernel for a given instruction set (falls back to scalar off x86)
+inline PhaseKernel phaseKernel(SimdLevel level) {
+#ifdef SIMD_KERNELS_X86
+    switch (level) {
+        case SIMD_AVX512: return compareExchangePhaseAVX512;
+        case SIMD_AVX2: return compareExchangePhaseAVX2;
+        case SIMD_SSE41: return compareExchangePhaseSSE41;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    return compareExchangePhaseScalar;
+}
+
+// Compare-exchange of count adjacent pairs with the best kernel of this CPU
+inline void compareExchangePhase(int* arr, long count) {
+    static const PhaseKernel kernel = phaseKernel(detectSimdLevel());
+    kernel(arr, count);
+}
+
+// ----- Median-of-three triplet kernels -----
+// Sorts count packed triplets (arr[3t], arr[3t + 1], arr[3t + 2]) with the
+// 3-element network lo = min(a, b), hi = max(a, b), min(lo, c),
+// max(lo, min(hi, c)), max(hi, c). Min and max only, so nothing can overflow.
+
+inline void sortTripletsScalar(int* arr, long count) {
+    for (long t = 0; t < count; t++) {
+        int a = arr[3 * t], b = arr[3 * t + 1], c = arr[3 * t + 2];
+        int lo = std::min(a, b), hi = std::max(a, b);
+        arr[3 * t] = std::min(lo, c);
+        arr[3 * t + 1] = std::max(lo, std::min(hi, c));
+        arr[3 * t + 2] = std::max(hi, c);
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+// 8 triplets per step: the 24 ints in three registers are de-interleaved into
+// the stride-3 lanes a, b and c with blends plus one lane permute each, run
+// through the network, and re-interleaved by the inverse permutes and blends
+__attribute__((target("avx2")))
+inline void sortTripletsAVX2(int* arr, long count) {
+    const __m256i gatherA = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+    const __m256i gatherB = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+    const __m256i gatherC = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+    const __m256i scatterB = _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2);
+    long t = 0;
+    for (; t + 8 <= count; t += 8) {
+        __m256i* base = reinterpret_cast<__m256i*>(arr + 3 * t);
+        __m256i v0 = _mm256_loadu_si256(base);
+        __m256i v1 = _mm256_loadu_si256(base + 1);
+        __m256i v2 = _mm256_loadu_si256(base + 2);
+
+        // Lane k of each blend holds element k of v0, v1 or v2
+        __m256i a = _mm256_permutevar8x32_epi32(
+            _mm256_blend_epi32(_mm256_blend_epi32(v0, v1, 0x92), v2, 0x24), gatherA);
+        __m256i b = _mm256_permutevar8x32_epi32(
+            _mm256_blend_epi32(_mm256_blend_epi32(v0, v1, 0x24), v2, 0x49), gatherB);
+        __m256i c = _mm256_permutevar8x32_epi32(
+            _mm256_blend_epi32(_mm256_blend_epi32(v0, v1, 0x49), v2, 0x92), gatherC);
+
+        __m256i lo = _mm256_min_epi32(a, b);
+        __m256i hi = _mm256_max_epi32(a, b);
+        a = _mm256_min_epi32(lo, c);
+        b = _mm256_max_epi32(lo, _mm256_min_epi32(hi, c));
+        c = _mm256_max_epi32(hi, c);
+
+        // gatherA and gatherC are their own inverses
+        a = _mm256_permutevar8x32_epi32(a, gatherA);
+        b = _mm256_permutevar8x32_epi32(b, scatterB);
+        c = _mm256_permutevar8x32_epi32(c, gatherC);
+        _mm256_storeu_si256(base, _mm256_blend_epi32(_mm256_blend_epi32(a, b, 0x92), c, 0x24));
+        _mm256_storeu_si256(base + 1, _mm256_blend_epi32(_mm256_blend_epi32(a, b, 0x24), c, 0x49));
+        _mm256_storeu_si256(base + 2, _mm256_blend_epi32(_mm256_blend_epi32(a, b, 0x49), c, 0x92));
+    }
+    sortTripletsScalar(arr + 3 * t, count - t);
+}
+#endif
+
+typedef void (*TripletKernel)(int*, long);
+
+// Triplet kernel for a given instruction set; AVX-512 CPUs run the AVX2 one
+inline TripletKernel tripletKernel(SimdLevel level) {
+#ifdef SIMD_KERNELS_X86
+    if (level >= SIMD_AVX2) {
+        return sortTripletsAVX2;
+    }
+#else
+    (void)level;
+#endif
+    return sortTripletsScalar;
+}
+
+// Sorts count packed triplets with the best kernel of this CPU
+inline void sortTriplets(int* arr, long count) {
+    static const TripletKernel kernel = tripletKernel(detectSimdLevel());
+    kernel(arr, count);
+}
+
+// ----- Sorted blocks of 8 -----
+// The first three levels of a Batcher network (merge sizes 2, 4 and 8) only
+// pair keys less than 8 apart, so they run inside one 8-lane register: sorts
+// the blocks [first, last) of 8 keys starting at arr, and with alternate the
+// odd blocks descending, which is the bitonic order the fourth level needs.
+
+inline void sortBlockOf8Scalar(int* block, bool descending) {
+    // Bitonic network of 8: levels k = 2, 4, 8 with strides j = k / 2 ... 1
+    for (int k = 2; k <= 8; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            for (int i = 0; i < 8; i++) {
+                if ((i & j) == 0) {
+                    int lo = std::min(block[i], block[i | j]);
+                    int hi = std::max(block[i], block[i | j]);
+                    bool up = (i & k) == 0 || k == 8;
+                    block[i] = up ? lo : hi;
+                    block[i | j] = up ? hi : lo;
+                }
+            }
+        }
+    }
+    if (descending) {
+        std::reverse(block, block + 8);
+    }
+}
+
+inline void sortBlocksOf8Scalar(int* arr, long first, long last, bool alternate) {
+    for (long b = first; b < last; b++) {
+        sortBlockOf8Scalar(arr + 8 * b, alternate && (b & 1));
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+// One network step: every lane meets its partner lane, takes the min or the
+// max, and the blend mask (lanes that keep the max) encodes the direction
+#define SIMD_BITONIC_STEP(v, partner, mask)                                    \
+    do {                                                                       \
+        __m256i other = (partner);                                             \
+        v = _mm256_blend_epi32(_mm256_min_epi32(v, other), _mm256_max_epi32(v, other), mask); \
+    } while (0)
+
+__attribute__((target("avx2")))
+inline void sortBlocksOf8AVX2(int* arr, long first, long last, bool alternate) {
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    for (long b = first; b < last; b++) {
+        __m256i* block = reinterpret_cast<__m256i*>(arr + 8 * b);
+        __m256i v = _mm256_loadu_si256(block);
+        // k = 2
+        SIMD_BITONIC_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0x66);
+        // k = 4
+        SIMD_BITONIC_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0x3C);
+        SIMD_BITONIC_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0x5A);
+        // k = 8
+        SIMD_BITONIC_STEP(v, _mm256_permute2x128_si256(v, v, 0x01), 0xF0);
+        SIMD_BITONIC_STEP(v, _mm256_shuffle_epi32(v, 0x4E), 0xCC);
+        SIMD_BITONIC_STEP(v, _mm256_shuffle_epi32(v, 0xB1), 0xAA);
+        if (alternate && (b & 1)) {
+            v = _mm256_permutevar8x32_epi32(v, reverse);
+        }
+        _mm256_storeu_si256(block, v);
+    }
+}
+#undef SIMD_BITONIC_STEP
+#endif
+
+typedef void (*BlockKernel)(int*, long, long, bool);
+
+// Block kernel for a given instruction set; AVX-512 CPUs run the AVX2 one
+inline BlockKernel blockKernel(SimdLevel level) {
+#ifdef SIMD_KERNELS_X86
+    if (level >= SIMD_AVX2) {
+        return sortBlocksOf8AVX2;
+    }
+#else
+    (void)level;
+#endif
+    return sortBlocksOf8Scalar;
+}
+
+// Sorts the blocks of 8 [first, last) with the best kernel of this CPU
+inline void sortBlocksOf8(int* arr, long first, long last, bool alternate) {
+    static const BlockKernel kernel = blockKernel(detectSimdLevel());
+    kernel(arr, first, last, alternate);
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <x86intrin.h>
+#include "simd_kernels.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+// Runs `phases` alternating odd and even phases over arr and returns the
+// elements processed per TSC cycle
+double elementsPerCycle(PhaseKernel kernel, vector<int>& arr, int phases) {
+    long n = arr.size();
+    unsigned long long start = __rdtsc();
+    for (int i = 1; i <= phases; i++) {
+        long first = (i % 2 == 1) ? 0 : 1;
+        kernel(arr.data() + first, (n - first) / 2);
+    }
+    unsigned long long cycles = __rdtsc() - start;
+    return static_cast<double>(n) * phases / cycles;
+}
+
+// Microbenchmark of one odd/even phase over 1M ints for every kernel this CPU
+// supports. Cycles are TSC reference cycles.
+int main(int argc, char* argv[]) {
+    int size = argc > 1 ? atoi(argv[1]) : 1000000;
+    int phases = argc > 2 ? atoi(argv[2]) : 200;
+    SimdLevel best = detectSimdLevel();
+
+    cout << "=== Odd/Even Phase Kernels (" << size << " ints, " << phases << " phases) ===" << endl;
+    cout << "Detected: " << simdLevelName(best) << endl << endl;
+    cout << left << setw(12) << "Kernel" << setw(20) << "Elements/cycle"
+         << setw(12) << "Speedup" << "Verification" << endl;
+    cout << string(56, '-') << endl;
+
+    vector<int> input = generateRandomArray(size);
+    double scalar = 0;
+    vector<int> reference;
+    for (int level = SIMD_SCALAR; level <= best; level++) {
+        PhaseKernel kernel = phaseKernel(static_cast<SimdLevel>(level));
+
+        // Warm-up pass, then the timed passes on a fresh copy
+        vector<int> arr = input;
+        elementsPerCycle(kernel, arr, 2);
+        arr = input;
+        double rate = elementsPerCycle(kernel, arr, phases);
+        if (level == SIMD_SCALAR) {
+            scalar = rate;
+            reference = arr;
+        }
+
+        cout << left << setw(12) << simdLevelName(static_cast<SimdLevel>(level))
+             << setw(20) << fixed << setprecision(3) << rate
+             << setw(12) << setprecision(2) << rate / scalar
+             << (arr == reference ? "Correct" : "Incorrect") << endl;
+    }
+    return 0;
+}
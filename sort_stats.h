@@ -0,0 +1,101 @@
+#ifndef SORT_STATS_H
+#define SORT_STATS_H
+
+#include <vector>
+
+// What a sort run did, next to how long it took
+struct SortStats {
+    double milliseconds;
+    // Rounds actually executed (fewer than the fixed bound in adaptive mode)
+    long rounds;
+    // Compare-exchanges that changed the data, -1 where the engine does not count them
+    long swaps;
+};
+
+// Per-worker exchange counts for the adaptive engines. A worker records its
+// count for a round before the round barrier; after the barrier every worker
+// sums the same counts and so takes the same stop decision. Two slots are
+// enough: slot r % 2 is only overwritten in round r + 2, after every worker
+// has passed the barrier of round r + 1 and therefore finished reading it.
+class ExchangeCounter {
+public:
+    explicit ExchangeCounter(int workers) : counts(workers) {}
+
+    void record(int worker, long round, long swaps) {
+        counts[worker].round[round % 2] = swaps;
+        counts[worker].total += swaps;
+    }
+
+    // Exchanges of all workers in a round, valid after its barrier
+    long roundTotal(long round) const {
+        long sum = 0;
+        for (const PaddedCount& count : counts) {
+            sum += count.round[round % 2];
+        }
+        return sum;
+    }
+
+    // Exchanges of all workers over the whole run, valid after the run
+    long total() const {
+        long sum = 0;
+        for (const PaddedCount& count : counts) {
+            sum += count.total;
+        }
+        return sum;
+    }
+
+private:
+    // Padded so neighbouring workers do not share a cache line
+    struct PaddedCount {
+        long round[2] = {0, 0};
+        long total = 0;
+        char pad[40];
+    };
+
+    std::vector<PaddedCount> counts;
+};
+
+// Block exchanges between neighbouring workers, and how many of them crossed
+// a NUMA node because the two workers sit on different sockets. Each worker
+// records the merge-splits it takes part in, so a pair is counted from both
+// sides: exchanges are halved in the totals, keys are what each side read
+// from its partner's block.
+class CrossNodeCounter {
+public:
+    explicit CrossNodeCounter(int workers = 0) : counts(workers) {}
+
+    void reset(int workers) { counts.assign(workers, PaddedCount()); }
+
+    void record(int worker, bool crossNode, long keys) {
+        counts[worker].exchanges++;
+        if (crossNode) {
+            counts[worker].crossExchanges++;
+            counts[worker].crossKeys += keys;
+        }
+    }
+
+    long exchanges() const { return sum(&PaddedCount::exchanges) / 2; }
+    long crossNodeExchanges() const { return sum(&PaddedCount::crossExchanges) / 2; }
+    long crossNodeKeys() const { return sum(&PaddedCount::crossKeys); }
+
+private:
+    // Padded so neighbouring workers do not share a cache line
+    struct PaddedCount {
+        long exchanges = 0;
+        long crossExchanges = 0;
+        long crossKeys = 0;
+        char pad[40];
+    };
+
+    long sum(long PaddedCount::*field) const {
+        long total = 0;
+        for (const PaddedCount& count : counts) {
+            total += count.*field;
+        }
+        return total;
+    }
+
+    std::vector<PaddedCount> counts;
+};
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef STATIC_NETWORK_H
+#define STATIC_NETWORK_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include "alternative_time_optimal_sort.h"
+
+// Sorting networks for a size N fixed at compile time. The schedule of the
+// odd-even transposition, the mod-3 median and Batcher's merge exchange
+// network is expanded at compile time into a straight line of
+// compare-exchanges with constant indices: no (i + 1) % 3 center arithmetic,
+// no boundary tests and no per-round bookkeeping are left at run time, only
+// branchless min/max. The transposition schedules repeat every two or three
+// rounds, so they keep one loop over that period; Batcher is unrolled whole.
+// staticNetworkSort dispatches a run-time size to the specialization for
+// N <= STATIC_NETWORK_MAX and loops over the same schedule above it.
+
+enum StaticNetwork { STATIC_ODD_EVEN, STATIC_MOD3, STATIC_BATCHER };
+
+const size_t STATIC_NETWORK_MAX = 64;
+
+inline const char* staticNetworkName(StaticNetwork network) {
+    switch (network) {
+        case STATIC_MOD3: return "mod-3";
+        case STATIC_BATCHER: return "batcher";
+        default: return "odd-even";
+    }
+}
+
+// Two selects on one comparison: GCC turns a std::min/std::max pair on the
+// same keys back into a branch, this compiles to cmov or vector min/max
+template <size_t I, size_t J, class T>
+inline void staticCompareExchange(T* a) {
+    T x = a[I], y = a[J];
+    bool swap = y < x;
+    a[I] = swap ? y : x;
+    a[J] = swap ? x : y;
+}
+
+// 0 .. N - 1 as a parameter pack, built by halves so the recursion depth is
+// log2(N)
+template <size_t... I>
+struct StaticIndices {};
+
+template <class A, class B>
+struct StaticConcat;
+
+template <size_t... A, size_t... B>
+struct StaticConcat<StaticIndices<A...>, StaticIndices<B...> > {
+    typedef StaticIndices<A..., (sizeof...(A) + B)...> type;
+};
+
+template <size_t N>
+struct StaticRange {
+    typedef typename StaticConcat<typename StaticRange<N / 2>::type,
+                                  typename StaticRange<N - N / 2>::type>::type type;
+};
+
+template <>
+struct StaticRange<0> {
+    typedef StaticIndices<> type;
+};
+
+template <>
+struct StaticRange<1> {
+    typedef StaticIndices<0> type;
+};
+
+// A schedule lists its compare-exchanges in order: count() of them, the
+// e-th pairing low(e) < high(e), repeating every period() exchanges.
+// Everything is a constant expression, so staticApply turns the list into
+// straight-line code with one instantiation per distinct pair, shared by
+// every N.
+
+// ----- Odd-even transposition -----
+// N rounds; every two rounds hold N - 1 exchanges, the N / 2 of the odd
+// round (0, 1), (2, 3)... then the (N - 1) / 2 of the even round (1, 2)...
+
+template <size_t N>
+struct StaticOddEven {
+    static constexpr size_t count() { return N / 2 * (N - 1) + (N % 2 == 1 ? N / 2 : 0); }
+    static constexpr size_t period() { return N > 1 ? N - 1 : 1; }
+    static constexpr size_t low(size_t e) {
+        return e % (N - 1) < N / 2 ? 2 * (e % (N - 1)) : 2 * (e % (N - 1) - N / 2) + 1;
+    }
+    static constexpr size_t high(size_t e) { return low(e) + 1; }
+};
+
+// ----- Mod-3 median schedule -----
+// Rounds 1 .. N - 1; round i sorts the triplets around the centers
+// firstCenter(i), + 3, ... as the exchanges (c - 1, c), (c, c + 1),
+// (c - 1, c). A center at either end only has its pair, which is the first
+// exchange of a triplet at the top end and (0, 1) at the bottom.
+
+// firstCenter as a constant expression
+constexpr size_t staticFirstCenter(size_t round) {
+    return (round + 1) % 3 == 0 ? 2 : (round + 1) % 3 == 1 ? 0 : 1;
+}
+
+template <size_t N>
+struct StaticMod3 {
+    static constexpr size_t centers(size_t i) {
+        return staticFirstCenter(i) < N ? (N - 1 - staticFirstCenter(i)) / 3 + 1 : 0;
+    }
+    static constexpr size_t lastCenter(size_t i) { return staticFirstCenter(i) + 3 * (centers(i) - 1); }
+    static constexpr size_t roundSize(size_t i) {
+        return centers(i) == 0 ? 0
+             : 3 * centers(i) - (staticFirstCenter(i) == 0 ? 2 : 0)
+                              - (lastCenter(i) != 0 && lastCenter(i) + 1 >= N ? 2 : 0);
+    }
+    static constexpr size_t count(size_t i = 1) { return i < N ? roundSize(i) + count(i + 1) : 0; }
+
+    // Exchange p of the triplets from center first on
+    static constexpr size_t inTriplets(size_t first, size_t p, bool high) {
+        return p % 3 == 1 ? first + 3 * (p / 3) + (high ? 1 : 0) : first + 3 * (p / 3) - (high ? 0 : 1);
+    }
+    static constexpr size_t inRound(size_t i, size_t p, bool high) {
+        return staticFirstCenter(i) != 0 ? inTriplets(staticFirstCenter(i), p, high)
+             : p == 0 ? (high ? 1 : 0) : inTriplets(3, p - 1, high);
+    }
+    // A round depends on i only through i % 3, so the schedule repeats every
+    // three rounds and exchange e is found without walking the rounds
+    static constexpr size_t block() { return roundSize(1) + roundSize(2) + roundSize(3); }
+    static constexpr size_t period() { return block() > 0 ? block() : 1; }
+    static constexpr size_t inBlock(size_t p, bool high) {
+        return p < roundSize(1) ? inRound(1, p, high)
+             : p < roundSize(1) + roundSize(2) ? inRound(2, p - roundSize(1), high)
+             : inRound(3, p - roundSize(1) - roundSize(2), high);
+    }
+    static constexpr size_t at(size_t e, bool high) { return inBlock(e % block(), high); }
+    static constexpr size_t low(size_t e) { return at(e, false); }
+    static constexpr size_t high(size_t e) { return at(e, true); }
+};
+
+// ----- Batcher merge exchange -----
+// Knuth's formulation of Batcher's odd-even merge, valid for any N: for p =
+// 2^(t-1), ..., 1 (2^t >= N) and the steps (q, r, d) starting at
+// (2^(t-1), 0, p), exchange i and i + d wherever i & p == r, then move to
+// (q / 2, p, q - p) until q == p.
+
+constexpr size_t staticTopBit(size_t n, size_t p = 1) {
+    return 2 * p >= n ? p : staticTopBit(n, 2 * p);
+}
+
+template <size_t N>
+struct StaticBatcher {
+    static constexpr size_t top() { return staticTopBit(N); }
+    // Number of i < N - d with i & p == r, and the k-th of them
+    static constexpr size_t stepSize(size_t p, size_t r, size_t d) {
+        return (N - d) / (2 * p) * p +
+               ((N - d) % (2 * p) <= r ? 0 : (N - d) % (2 * p) - r < p ? (N - d) % (2 * p) - r : p);
+    }
+    static constexpr size_t stepIndex(size_t k, size_t p, size_t r) { return k / p * 2 * p + r + k % p; }
+
+    static constexpr size_t countFrom(size_t p, size_t q, size_t r, size_t d) {
+        return p == 0 ? 0
+             : stepSize(p, r, d) + (q == p ? countFrom(p / 2, top(), 0, p / 2) : countFrom(p, q / 2, p, q - p));
+    }
+    static constexpr size_t count() { return N > 1 ? countFrom(top(), top(), 0, top()) : 0; }
+    static constexpr size_t period() { return count() > 0 ? count() : 1; }
+
+    static constexpr size_t at(size_t e, size_t p, size_t q, size_t r, size_t d, bool high) {
+        return e < stepSize(p, r, d) ? stepIndex(e, p, r) + (high ? d : 0)
+             : q == p ? at(e - stepSize(p, r, d), p / 2, top(), 0, p / 2, high)
+             : at(e - stepSize(p, r, d), p, q / 2, p, q - p, high);
+    }
+    static constexpr size_t low(size_t e) { return at(e, top(), top(), 0, top(), false); }
+    static constexpr size_t high(size_t e) { return at(e, top(), top(), 0, top(), true); }
+};
+
+template <StaticNetwork Network, size_t N>
+struct StaticSchedule {
+    typedef StaticOddEven<N> type;
+};
+
+template <size_t N>
+struct StaticSchedule<STATIC_MOD3, N> {
+    typedef StaticMod3<N> type;
+};
+
+template <size_t N>
+struct StaticSchedule<STATIC_BATCHER, N> {
+    typedef StaticBatcher<N> type;
+};
+
+// Runs exchanges E... of the schedule, in order
+template <class Schedule, class T, size_t... E>
+inline void staticApply(T* a, StaticIndices<E...>) {
+    int unused[] = {0, (staticCompareExchange<Schedule::low(E), Schedule::high(E)>(a), 0)...};
+    (void)unused;
+    (void)a;
+}
+
+// Sorts a with the network unrolled for N: one period of the schedule as
+// straight-line code, run count / period times (a constant trip count the
+// compiler may unroll further), then the first count % period exchanges.
+// Unrolling all N^2 / 2 exchanges of the transposition schedules took
+// minutes of compile time per key type.
+template <StaticNetwork Network, size_t N, class T>
+inline void staticSort(T* a) {
+    typedef typename StaticSchedule<Network, N>::type Schedule;
+    const size_t periods = Schedule::count() / Schedule::period();
+    for (size_t p = 0; p < periods; p++) {
+        staticApply<Schedule>(a, typename StaticRange<(periods > 0 ? Schedule::period() : 0)>::type());
+    }
+    staticApply<Schedule>(a, typename StaticRange<Schedule::count() % Schedule::period()>::type());
+}
+
+template <StaticNetwork Network, class T, size_t N>
+inline void staticSort(std::array<T, N>& arr) {
+    staticSort<Network, N>(arr.data());
+}
+
+// ----- Run-time schedules -----
+// The same three networks as loops over a run-time n, for sizes above
+// STATIC_NETWORK_MAX and as the baseline of the specializations.
+
+template <class T>
+inline void runtimeNetworkSort(T* a, size_t n, StaticNetwork network) {
+    if (n < 2) {
+        return;
+    }
+    if (network == STATIC_MOD3) {
+        for (size_t i = 1; i < n; i++) {
+            for (size_t center = firstCenter(i); center < n; center += 3) {
+                sortTriplet(a, n, center);
+            }
+        }
+    } else if (network == STATIC_BATCHER) {
+        size_t top = staticTopBit(n);
+        for (size_t p = top; p > 0; p /= 2) {
+            size_t q = top, r = 0, d = p;
+            while (true) {
+                for (size_t i = 0; i + d < n; i++) {
+                    if ((i & p) == r) {
+                        T lo = std::min(a[i], a[i + d]), hi = std::max(a[i], a[i + d]);
+                        a[i] = lo;
+                        a[i + d] = hi;
+                    }
+                }
+                if (q == p) {
+                    break;
+                }
+                d = q - p;
+                q /= 2;
+                r = p;
+            }
+        }
+    } else {
+        for (size_t i = 1; i <= n; i++) {
+            for (size_t k = (i % 2 == 1) ? 0 : 1; k + 1 < n; k += 2) {
+                T lo = std::min(a[k], a[k + 1]), hi = std::max(a[k], a[k + 1]);
+                a[k] = lo;
+                a[k + 1] = hi;
+            }
+        }
+    }
+}
+
+// Table of the specializations 0 .. STATIC_NETWORK_MAX of one network,
+// filled from the top down by template recursion
+template <StaticNetwork Network, class T, size_t N>
+struct StaticNetworkTable {
+    static void fill(void (**table)(T*)) {
+        table[N] = staticSort<Network, N, T>;
+        StaticNetworkTable<Network, T, N - 1>::fill(table);
+    }
+};
+
+template <StaticNetwork Network, class T>
+struct StaticNetworkTable<Network, T, 0> {
+    static void fill(void (**table)(T*)) { table[0] = staticSort<Network, 0, T>; }
+};
+
+template <StaticNetwork Network, class T>
+inline void staticNetworkDispatch(T* a, size_t n) {
+    struct Table {
+        void (*sort[STATIC_NETWORK_MAX + 1])(T*);
+        Table() { StaticNetworkTable<Network, T, STATIC_NETWORK_MAX>::fill(sort); }
+    };
+    static const Table table;
+    table.sort[n](a);
+}
+
+// Sorts a[0, n) with the network: the unrolled specialization for n <=
+// STATIC_NETWORK_MAX, the run-time schedule above
+template <class T>
+inline void staticNetworkSort(T* a, size_t n, StaticNetwork network) {
+    if (n > STATIC_NETWORK_MAX) {
+        runtimeNetworkSort(a, n, network);
+    } else if (network == STATIC_MOD3) {
+        staticNetworkDispatch<STATIC_MOD3>(a, n);
+    } else if (network == STATIC_BATCHER) {
+        staticNetworkDispatch<STATIC_BATCHER>(a, n);
+    } else {
+        staticNetworkDispatch<STATIC_ODD_EVEN>(a, n);
+    }
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include "odd_even_transposition_sort.h"
+#include "static_network.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+// Sorts every array of length n in data with sortOne and returns the
+// nanoseconds per array
+template <class Sort>
+double nanosecondsPerArray(vector<int>& data, long n, Sort sortOne) {
+    long count = data.size() / n;
+    auto start = chrono::high_resolution_clock::now();
+    for (long a = 0; a < count; a++) {
+        sortOne(data.data() + a * n);
+    }
+    chrono::duration<double, nano> duration = chrono::high_resolution_clock::now() - start;
+    return duration.count() / count;
+}
+
+// The compile-time networks (dispatched on the run-time length) against the
+// same schedules as run-time loops, the SIMD tile kernels the hybrid sort
+// uses, and std::sort, on one thread. Arguments: number of arrays per
+// length (default 100000).
+int main(int argc, char* argv[]) {
+    long count = argc > 1 ? atol(argv[1]) : 100000;
+    vector<long> lengths = {8, 16, 24, 32, 48, 64};
+    vector<StaticNetwork> networks = {STATIC_ODD_EVEN, STATIC_MOD3, STATIC_BATCHER};
+
+    cout << "=== Compile-Time Networks (" << count << " arrays per length, ns per array) ===" << endl;
+    cout << left << setw(12) << "Network" << setw(8) << "Length" << setw(14) << "Runtime(ns)"
+         << setw(12) << "Tile(ns)" << setw(12) << "Static(ns)" << setw(14) << "std::sort(ns)"
+         << setw(10) << "Speedup" << "Verification" << endl;
+    cout << string(94, '-') << endl;
+
+    for (StaticNetwork network : networks) {
+        for (long n : lengths) {
+            vector<int> input = generateRandomArray(count * n);
+            vector<int> expected = input;
+            double sortTime = nanosecondsPerArray(expected, n, [&](int* a) { sort(a, a + n); });
+
+            vector<int> loops = input;
+            double runtimeTime = nanosecondsPerArray(loops, n, [&](int* a) {
+                runtimeNetworkSort(a, n, network);
+            });
+
+            // Batcher has no single-thread tile kernel
+            vector<int> tiles = input;
+            double tileTime = -1;
+            if (network == STATIC_ODD_EVEN) {
+                tileTime = nanosecondsPerArray(tiles, n, [&](int* a) { oddEvenTranspositionSortTile(a, n); });
+            } else if (network == STATIC_MOD3) {
+                tileTime = nanosecondsPerArray(tiles, n, [&](int* a) { alternateTimeOptimalSortingTile(a, n); });
+            }
+
+            vector<int> unrolled = input;
+            double staticTime = nanosecondsPerArray(unrolled, n, [&](int* a) {
+                staticNetworkSort(a, n, network);
+            });
+
+            bool correct = loops == expected && (tileTime < 0 || tiles == expected) && unrolled == expected;
+            cout << left << setw(12) << staticNetworkName(network) << setw(8) << n
+                 << setw(14) << fixed << setprecision(1) << runtimeTime;
+            if (tileTime < 0) {
+                cout << setw(12) << "-";
+            } else {
+                cout << setw(12) << tileTime;
+            }
+            cout << setw(12) << staticTime << setw(14) << sortTime
+                 << setw(10) << setprecision(2) << runtimeTime / staticTime
+                 << (correct ? "Correct" : "Incorrect") << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+#ifndef SYSTOLIC_SORT_H
+#define SYSTOLIC_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "worker_pool.h"
+
+// Streaming mode of the linear process chain: the chain stays alive as a
+// systolic array and sorts an unbounded stream of windows of width keys.
+// Every cycle one key enters node 0 and one sorted key leaves node
+// width - 1, so windows flow in while the previous one drains out and the
+// steady state sorts one window per width cycles, with no setup or teardown
+// in between.
+//
+// Each node holds one key tagged with its window. A key arriving from the
+// left meets the held key:
+//  - same window: the node keeps the larger and passes the smaller on, so
+//    once a window is in, node i holds its (i + 1)-th largest key;
+//  - newer window: the held key is final, the node passes it on and keeps
+//    the new one. The passed keys ripple through the rest of the old window
+//    by the same-window rule and leave node width - 1 smallest first.
+// Links carry keys in window order, so a node has seen all of a window
+// before the first key of the next one arrives. Bubbles (a window of +inf
+// placeholders) fill the nodes and links at start and flush the last window
+// out; they never reach the output.
+
+struct SystolicReport {
+    double milliseconds;
+    long windows;
+    long cycles;
+    // Cycles per window over the whole run, width in steady state
+    double cyclesPerWindow;
+};
+
+// Node i takes the key on link i (arriving) and passes one on link i + 1
+// (passed). Tags pack a key's window and a bubble bit, see SystolicSorter.
+// Only selects in the loop body, so it vectorizes.
+template <class T>
+void systolicStep(const T* __restrict arrivingKey, const long* __restrict arrivingTag, T* __restrict passedKey,
+                  long* __restrict passedTag, T* __restrict key, long* __restrict tag, long begin, long end) {
+    for (long i = begin; i < end; i++) {
+        T a = arrivingKey[i], m = key[i];
+        long aTag = arrivingTag[i], mTag = tag[i];
+        bool less = !(aTag & 1) && ((mTag & 1) || a < m);
+        long aWindow = aTag >> 1, mWindow = mTag >> 1;
+        // Only the start-up bubbles on the links can be older than the node
+        bool passArriving = aWindow < mWindow || (aWindow == mWindow && less);
+        passedKey[i] = passArriving ? a : m;
+        passedTag[i] = passArriving ? aTag : mTag;
+        key[i] = passArriving ? m : a;
+        tag[i] = passArriving ? mTag : aTag;
+    }
+}
+
+template <class T>
+class SystolicSorter {
+public:
+    typedef std::function<bool(std::vector<T>&)> Source;
+    typedef std::function<void(const std::vector<T>&)> Sink;
+
+    SystolicSorter(long width, WorkerPool& pool)
+        : width(width), pool(pool), nextWindow(0), heldKey(width), heldTag(width, bubbleTag(-1)) {
+        for (int b = 0; b < 2; b++) {
+            linkKey[b].assign(width + 1, T());
+            linkTag[b].assign(width + 1, bubbleTag(-1));
+        }
+    }
+
+    // Streams windows through the chain until source returns false. source
+    // fills the next window (width keys), sink gets every window sorted, in
+    // input order. The chain keeps its state between calls.
+    SystolicReport run(const Source& source, const Sink& sink) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<T> input, output;
+        output.reserve(width);
+        long fed = width, windowsIn = 0, windowsOut = 0, cycles = 0;
+        bool streaming = true;
+        // Written by worker 0 in cycle t, read by everybody after its barrier
+        // and rewritten in cycle t + 2, once everybody has read it
+        bool done[2] = {false, false};
+
+        pool.run([&](int worker) {
+            long begin, end;
+            pool.chunk(width, worker, begin, end);
+            for (long t = 0; t == 0 || !done[(t - 1) % 2]; t++) {
+                SORT_TRACE_BEGIN("cycle", t);
+                int in = t % 2, out = (t + 1) % 2;
+                if (worker == 0) {
+                    // Key that left the chain in the previous cycle
+                    if (t > 0 && !isBubble(linkTag[in][width])) {
+                        output.push_back(linkKey[in][width]);
+                        if (static_cast<long>(output.size()) == width) {
+                            sink(output);
+                            output.clear();
+                            windowsOut++;
+                        }
+                    }
+                    done[t % 2] = !streaming && windowsOut == windowsIn;
+                    cycles = t;
+                    feed(source, input, fed, windowsIn, streaming, linkKey[in][0], linkTag[in][0]);
+                }
+                stepRange(in, out, begin, end);
+                SORT_TRACE_END("cycle", t);
+                pool.barrier(worker);
+            }
+        });
+        // The chain now holds the bubbles of window nextWindow + windowsIn
+        nextWindow += windowsIn + 1;
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> duration = end - start;
+        SystolicReport report = {duration.count(), windowsOut, cycles,
+                                 windowsOut > 0 ? static_cast<double>(cycles) / windowsOut : 0.0};
+        return report;
+    }
+
+private:
+    // A key's window and bubble flag packed into one tag
+    static long keyTag(long window) { return window * 2; }
+    static long bubbleTag(long window) { return window * 2 + 1; }
+    static long windowOf(long tag) { return tag >> 1; }
+    static bool isBubble(long tag) { return (tag & 1) != 0; }
+
+    // One cycle of nodes [begin, end)
+    void stepRange(int in, int out, long begin, long end) {
+        systolicStep(linkKey[in].data(), linkTag[in].data(), linkKey[out].data() + 1, linkTag[out].data() + 1,
+                     heldKey.data(), heldTag.data(), begin, end);
+    }
+
+    // Key entering node 0 this cycle: the next key of the current window,
+    // then, once the source is dry, bubbles of one more window
+    void feed(const Source& source, std::vector<T>& input, long& fed, long& windowsIn, bool& streaming,
+              T& key, long& tag) {
+        if (streaming && fed == width) {
+            input.resize(width);
+            streaming = source(input) && static_cast<long>(input.size()) == width;
+            if (streaming) {
+                fed = 0;
+                windowsIn++;
+            }
+        }
+        if (streaming) {
+            key = input[fed++];
+            tag = keyTag(nextWindow + windowsIn - 1);
+        } else {
+            key = T();
+            tag = bubbleTag(nextWindow + windowsIn);
+        }
+    }
+
+    long width;
+    WorkerPool& pool;
+    // Tag of the first window of the next run
+    long nextWindow;
+    // Key held by every node, and the keys on the links into node i (and
+    // out of the chain at width), double buffered by cycle parity
+    std::vector<T> heldKey;
+    std::vector<long> heldTag;
+    std::vector<T> linkKey[2];
+    std::vector<long> linkTag[2];
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include "sasaki_time_optimal_sort.h"
+#include "systolic_sort.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+void printRow(const string& mode, long width, long windows, double milliseconds, double cyclesPerWindow,
+              bool correct) {
+    cout << left << setw(20) << mode << setw(10) << width << setw(10) << windows
+         << setw(14) << fixed << setprecision(3) << milliseconds
+         << setw(14) << setprecision(0) << windows / (milliseconds / 1000)
+         << setw(18) << setprecision(1) << cyclesPerWindow
+         << (correct ? "Correct" : "Incorrect") << endl;
+}
+
+// A stream of fixed-size windows sorted by the systolic chain, which stays
+// alive across windows, against one Sasaki sort per window, which builds and
+// tears down its chain every time. Arguments: number of windows (default
+// 200) and pool threads (default: one per core).
+int main(int argc, char* argv[]) {
+    long windows = argc > 1 ? atol(argv[1]) : 200;
+    WorkerPool pool(argc > 2 ? atoi(argv[2]) : 0);
+    vector<long> widths = {16, 100, 1000};
+
+    cout << "=== Streaming Windows (" << pool.size() << " threads) ===" << endl;
+    cout << left << setw(20) << "Mode" << setw(10) << "Width" << setw(10) << "Windows" << setw(14) << "Time(ms)"
+         << setw(14) << "Windows/s" << setw(18) << "Cycles/window" << "Verification" << endl;
+    cout << string(96, '-') << endl;
+
+    for (long width : widths) {
+        vector<vector<int> > stream(windows);
+        vector<vector<int> > expected(windows);
+        for (long w = 0; w < windows; w++) {
+            stream[w] = generateRandomArray(width);
+            expected[w] = stream[w];
+            sort(expected[w].begin(), expected[w].end());
+        }
+
+        // Systolic chain: one call for the whole stream
+        SystolicSorter<int> sorter(width, pool);
+        long next = 0, checked = 0;
+        bool correct = true;
+        SystolicReport report = sorter.run(
+            [&](vector<int>& window) {
+                if (next == windows) return false;
+                window = stream[next++];
+                return true;
+            },
+            [&](const vector<int>& window) {
+                correct = correct && window == expected[checked++];
+            });
+        printRow("systolic stream", width, report.windows, report.milliseconds, report.cyclesPerWindow,
+                 correct && checked == windows);
+
+        // One Sasaki sort per window, n - 1 rounds each plus setup
+        double total = 0;
+        correct = true;
+        for (long w = 0; w < windows; w++) {
+            vector<int> arr = stream[w], result;
+            total += sasakiArenaTimeOptimalSort(arr, result, pool);
+            correct = correct && result == expected[w];
+        }
+        printRow("sasaki per window", width, windows, total, width - 1, correct);
+    }
+    return 0;
+}
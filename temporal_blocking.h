@@ -0,0 +1,131 @@
+#ifndef TEMPORAL_BLOCKING_H
+#define TEMPORAL_BLOCKING_H
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "alternative_time_optimal_sort.h"
+#include "odd_even_transposition_sort.h"
+#include "worker_pool.h"
+
+// Temporal blocking for the transposition schedules. A round of odd-even or
+// mod-3 is a 1D stencil: a comparator only depends on the comparators of the
+// previous round at most slope keys away (1 for odd-even, whose key is the
+// lower element of the pair, 2 for mod-3, whose key is the triplet center).
+// Instead of streaming the whole array through memory once per round, the
+// rounds are cut into bands of depth rounds and the array into tiles of
+// about tile elements, and every band runs in two phases:
+//
+//   A: each tile runs all rounds of the band on an upright trapezoid, which
+//      loses slope keys at each inner edge per round, so it only needs
+//      values that the same tile produced (tiles run in parallel);
+//   B: after the barrier, the inverted trapezoids around the tile boundaries
+//      run the comparators phase A left out, on values phase A finished.
+//
+// Every comparator runs exactly once, and every element goes through the
+// comparators that touch it in round order, so the result is bit-for-bit the
+// one of the untiled engines after the same rounds. A tile stays in cache for
+// the whole band, which cuts the traffic to memory by about depth times, and
+// a band costs two barriers instead of depth.
+
+// Tile size, band depth and tile count actually used for n keys: the last
+// tile absorbs the remainder of the array, and the depth is capped so that
+// the trapezoids of phase B never meet
+inline void temporalBlockingShape(long n, long slope, long& tile, long& depth, long& tiles) {
+    tile = std::max(tile, 2 * slope);
+    depth = std::max(1L, std::min(depth, tile / (2 * slope)));
+    tiles = std::max(1L, n / tile);
+}
+
+// Elements the executor streams through memory for rounds rounds, assuming
+// a tile stays in cache for its band and the array does not: one pass per
+// band for phase A plus the regions around the boundaries for phase B. The
+// untiled engines stream rounds * n.
+inline long temporalBlockingTraffic(long n, long rounds, long slope, long tile, long depth) {
+    long tiles;
+    temporalBlockingShape(n, slope, tile, depth, tiles);
+    long bands = (rounds + depth - 1) / depth;
+    return bands * (n + (tiles - 1) * 2 * depth * slope);
+}
+
+// Runs rounds 1 to rounds of a schedule whose comparators of round i with
+// keys in [begin, end) are applied by step(i, begin, end). Keys are clipped
+// to [0, n); tile and depth are adjusted by temporalBlockingShape.
+template <class Step>
+inline void temporalBlocking(long n, long rounds, long slope, long tile, long depth, WorkerPool& pool,
+                             const Step& step) {
+    long tiles;
+    temporalBlockingShape(n, slope, tile, depth, tiles);
+
+    pool.run([&](int worker) {
+        long tileBegin, tileEnd, boundaryBegin, boundaryEnd;
+        pool.chunk(tiles, worker, tileBegin, tileEnd);
+        pool.chunk(tiles - 1, worker, boundaryBegin, boundaryEnd);
+
+        for (long band = 0; band < rounds; band += depth) {
+            long bandRounds = std::min(depth, rounds - band);
+
+            // Phase A: upright trapezoids, the outer edges of the array stay put
+            SORT_TRACE_BEGIN("work", band + 1);
+            for (long k = tileBegin; k < tileEnd; k++) {
+                for (long t = 0; t < bandRounds; t++) {
+                    long begin = k == 0 ? 0 : k * tile + t * slope;
+                    long end = k == tiles - 1 ? n : (k + 1) * tile - t * slope;
+                    step(band + t + 1, begin, end);
+                }
+            }
+            SORT_TRACE_END("work", band + 1);
+            pool.barrier(worker);
+
+            // Phase B: inverted trapezoids around the inner tile boundaries
+            SORT_TRACE_BEGIN("work", band + 1);
+            for (long k = boundaryBegin + 1; k <= boundaryEnd; k++) {
+                for (long t = 1; t < bandRounds; t++) {
+                    step(band + t + 1, k * tile - t * slope, k * tile + t * slope);
+                }
+            }
+            SORT_TRACE_END("work", band + 1);
+            pool.barrier(worker);
+        }
+    });
+}
+
+// Odd-even transposition sort with temporal blocking: the first rounds rounds
+// (all n by default) of oddEvenTranspositionSortTile, on tiles of tile ints
+// depth rounds at a time. The defaults keep a tile in L2.
+inline double temporalOddEvenTranspositionSort(std::vector<int>& arr, WorkerPool& pool, long rounds = -1,
+                                               long tile = 16384, long depth = 2048) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+    temporalBlocking(n, rounds < 0 ? n : rounds, 1, tile, depth, pool, [&](long i, long begin, long end) {
+        compareExchangePhaseRange(data, n, i, begin, end);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+// Alternate time optimal sorting with temporal blocking: the first rounds
+// rounds (all n - 1 by default) of alternateTimeOptimalSortingTile. A triplet
+// reaches one element to either side, so its trapezoids lose two centers per
+// round.
+inline double temporalAlternateTimeOptimalSorting(std::vector<int>& arr, WorkerPool& pool, long rounds = -1,
+                                                  long tile = 16384, long depth = 2048) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    long n = arr.size();
+    int* data = arr.data();
+    temporalBlocking(n, rounds < 0 ? std::max(0L, n - 1) : rounds, 2, tile, depth, pool,
+                     [&](long i, long begin, long end) {
+        sortTripletCenters(data, n, i, std::max(0L, begin), end);
+    });
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> duration = end - start;
+    return duration.count();
+}
+
+#endif
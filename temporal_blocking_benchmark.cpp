@@ -0,0 +1,129 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include <functional>
+#include "perf_counters.h"
+#include "temporal_blocking.h"
+using namespace std;
+
+// Generate random array for testing
+vector<int> generateRandomArray(int size) {
+    vector<int> arr(size);
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(1, 1000);
+
+    for (int i = 0; i < size; i++) {
+        arr[i] = distrib(gen);
+    }
+
+    return arr;
+}
+
+// Time of one run and the last-level cache misses of all its threads. The
+// counters are inherited and the pool is created after them and joined
+// before the final read, so the pool threads are counted as well.
+struct Measurement {
+    double milliseconds;
+    long long llcMisses;
+};
+
+Measurement measure(int threads, const function<double(WorkerPool&)>& run) {
+    PerfCounters counters(true);
+    PerfSample before = counters.read();
+    Measurement result;
+    {
+        WorkerPool pool(threads);
+        result.milliseconds = run(pool);
+    }
+    result.llcMisses = perfDelta(before, counters.read()).values[PERF_LLC_MISSES];
+    return result;
+}
+
+void printRow(const string& schedule, long n, const string& depth, long elements, const Measurement& m,
+              double baseline, bool correct) {
+    cout << left << setw(12) << schedule << setw(10) << n << setw(8) << depth
+         << setw(14) << fixed << setprecision(1) << elements * sizeof(int) / 1e6;
+    if (m.llcMisses < 0) {
+        cout << setw(14) << "n/a";
+    } else {
+        cout << setw(14) << m.llcMisses;
+    }
+    cout << setw(12) << setprecision(2) << m.milliseconds
+         << setw(10) << baseline / m.milliseconds
+         << (correct ? "Correct" : "Incorrect") << endl;
+}
+
+// The SIMD pool engines, one barrier and one sweep over the array per round,
+// against temporal blocking on 16384-int tiles at several band depths. The
+// sizes double from 65536 keys (4 tiles) up to the largest size, so the
+// trapezoids are spread over several workers. Traffic is the modelled bytes
+// streamed through memory (temporalBlockingTraffic), next to the measured
+// LLC misses where the PMU is available. Verification checks the sorted
+// result and, after a third of the rounds, that the tiled array is
+// bit-for-bit the untiled one. Arguments: largest size (default 131072) and
+// pool threads (default: one per core).
+int main(int argc, char* argv[]) {
+    long maxSize = argc > 1 ? atol(argv[1]) : 131072;
+    int threads = argc > 2 ? atoi(argv[2]) : 0;
+    const long tile = 16384;
+    vector<long> depths = {16, 256, 2048};
+
+    cout << "=== Temporal Blocking (" << (threads > 0 ? threads : WorkerPool::defaultThreadCount())
+         << " threads, " << tile << "-int tiles) ===" << endl;
+    cout << left << setw(12) << "Schedule" << setw(10) << "Size" << setw(8) << "Depth" << setw(14) << "Traffic(MB)"
+         << setw(14) << "LLC misses" << setw(12) << "Time(ms)" << setw(10) << "Speedup" << "Verification" << endl;
+    cout << string(92, '-') << endl;
+
+    for (long n = 4 * tile; n <= maxSize; n *= 2) {
+        vector<int> input = generateRandomArray(n);
+        vector<int> expected = input;
+        sort(expected.begin(), expected.end());
+
+        for (int schedule = 0; schedule < 2; schedule++) {
+            bool alternate = schedule == 1;
+            string name = alternate ? "mod-3" : "odd-even";
+            long rounds = alternate ? n - 1 : n;
+            long slope = alternate ? 2 : 1;
+
+            vector<int> untiled = input;
+            Measurement baseline = measure(threads, [&](WorkerPool& pool) {
+                return alternate ? simdAlternateTimeOptimalSorting(untiled, pool)
+                                 : simdOddEvenTranspositionSort(untiled, pool);
+            });
+            printRow(name, n, "-", rounds * n, baseline, baseline.milliseconds, untiled == expected);
+
+            // Intermediate state of the untiled schedule, for the bit-for-bit check
+            vector<int> partial = input;
+            if (alternate) {
+                alternateTimeOptimalSortingTile(partial.data(), n, rounds / 3);
+            } else {
+                oddEvenTranspositionSortTile(partial.data(), n, rounds / 3);
+            }
+
+            for (long depth : depths) {
+                vector<int> tiled = input;
+                vector<int> tiledPartial = input;
+                Measurement m = measure(threads, [&](WorkerPool& pool) {
+                    return alternate ? temporalAlternateTimeOptimalSorting(tiled, pool, -1, tile, depth)
+                                     : temporalOddEvenTranspositionSort(tiled, pool, -1, tile, depth);
+                });
+                {
+                    WorkerPool pool(threads);
+                    if (alternate) {
+                        temporalAlternateTimeOptimalSorting(tiledPartial, pool, rounds / 3, tile, depth);
+                    } else {
+                        temporalOddEvenTranspositionSort(tiledPartial, pool, rounds / 3, tile, depth);
+                    }
+                }
+                bool correct = tiled == expected && tiledPartial == partial;
+                printRow(name, n, to_string(depth), temporalBlockingTraffic(n, rounds, slope, tile, depth), m,
+                         baseline.milliseconds, correct);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <string>
+
+// Timeline tracing of worker activity in the Chrome trace-event format
+// (chrome://tracing, ui.perfetto.dev). Build with -DSORT_TRACE to record;
+// otherwise SORT_TRACE_BEGIN/END/NAME expand to nothing and the engines
+// carry no tracing code at all.
+
+#ifdef SORT_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+// One begin or end mark of a span; round is -1 outside the round loops
+struct TraceEvent {
+    const char* name;
+    long round;
+    long long nanoseconds;
+    bool begin;
+};
+
+// Events of one thread. Only the owning thread appends, so recording takes
+// no lock; buffers are linked into a global list once, with a CAS, and stay
+// alive after their thread exits so short-lived threads still show up.
+struct TraceBuffer {
+    std::vector<TraceEvent> events;
+    std::string threadName;
+    int threadId;
+    TraceBuffer* next;
+};
+
+class TraceRecorder {
+public:
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    // Buffer of the calling thread, created on its first event
+    TraceBuffer& local() {
+        thread_local TraceBuffer* buffer = nullptr;
+        if (!buffer) {
+            buffer = new TraceBuffer();
+            buffer->events.reserve(64);
+            buffer->threadId = nextId.fetch_add(1);
+            buffer->next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(buffer->next, buffer, std::memory_order_release)) {
+            }
+        }
+        return *buffer;
+    }
+
+    void record(const char* name, long round, bool begin) {
+        long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+        TraceEvent event = {name, round, now, begin};
+        local().events.push_back(event);
+    }
+
+    // Drops every recorded event; no thread may be recording meanwhile
+    void reset() {
+        for (TraceBuffer* buffer = head.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            buffer->events.clear();
+        }
+    }
+
+    // Writes all events as Chrome trace JSON; call once the traced threads
+    // are joined or parked in the pool
+    bool write(const std::string& path) const {
+        std::ofstream out(path.c_str());
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        bool first = true;
+        for (TraceBuffer* buffer = head.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+            if (buffer->events.empty()) continue;
+            std::string name = buffer->threadName.empty() ? "thread " + std::to_string(buffer->threadId)
+                                                          : buffer->threadName;
+            out << (first ? "" : ",") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                << buffer->threadId << ", \"args\": {\"name\": \"" << name << "\"}}";
+            first = false;
+            for (const TraceEvent& event : buffer->events) {
+                out << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"" << (event.begin ? "B" : "E")
+                    << "\", \"pid\": 1, \"tid\": " << buffer->threadId << ", \"ts\": "
+                    << std::fixed << std::setprecision(3) << event.nanoseconds / 1000.0;
+                if (event.round >= 0) {
+                    out << ", \"args\": {\"round\": " << event.round << "}";
+                }
+                out << "}";
+            }
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out.flush());
+    }
+
+private:
+    TraceRecorder() : epoch(std::chrono::steady_clock::now()), head(nullptr), nextId(0) {}
+
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<TraceBuffer*> head;
+    std::atomic<int> nextId;
+};
+
+#define SORT_TRACE_BEGIN(name, round) TraceRecorder::instance().record(name, round, true)
+#define SORT_TRACE_END(name, round) TraceRecorder::instance().record(name, round, false)
+#define SORT_TRACE_NAME(label) TraceRecorder::instance().local().threadName = (label)
+
+inline bool traceCompiledIn() { return true; }
+inline void resetTrace() { TraceRecorder::instance().reset(); }
+inline bool writeTrace(const std::string& path) { return TraceRecorder::instance().write(path); }
+
+#else
+
+#define SORT_TRACE_BEGIN(name, round) ((void)0)
+#define SORT_TRACE_END(name, round) ((void)0)
+#define SORT_TRACE_NAME(label) ((void)0)
+
+inline bool traceCompiledIn() { return false; }
+inline void resetTrace() {}
+inline bool writeTrace(const std::string&) { return false; }
+
+#endif
+
+#endif
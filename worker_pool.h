@@ -0,0 +1,275 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "numa_topology.h"
+#include "trace_events.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Sense-reversing barrier used between rounds. Every worker keeps its own
+// sense flag; the last one to arrive resets the counter and flips the shared
+// sense, which releases everybody spinning on it.
+class SenseBarrier {
+public:
+    explicit SenseBarrier(int parties) : parties(parties), count(parties), sense(false) {}
+
+    void wait(bool& localSense) {
+        localSense = !localSense;
+        if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            count.store(parties, std::memory_order_relaxed);
+            sense.store(localSense, std::memory_order_release);
+        } else {
+            int spins = 0;
+            while (sense.load(std::memory_order_acquire) != localSense) {
+                // Back off so oversubscribed workers do not starve the last arrival
+                if (++spins > 1024) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+private:
+    const int parties;
+    std::atomic<int> count;
+    std::atomic<bool> sense;
+};
+
+// Per-worker round counters for the wavefront engines, which replace the
+// round barrier with neighbour-only synchronisation. A worker publishes the
+// last round it finished with a release store, and before starting round
+// r + 1 waits (acquire) until both neighbours have published round r. Fast
+// workers can run ahead of the array, but never more than one round ahead
+// of a neighbour, so a straggler only holds up the workers next to it.
+class NeighbourClock {
+public:
+    explicit NeighbourClock(int workers, long start = 0) : rounds(workers) {
+        for (PaddedRound& round : rounds) {
+            round.value.store(start, std::memory_order_relaxed);
+        }
+    }
+
+    void finish(int worker, long round) {
+        rounds[worker].value.store(round, std::memory_order_release);
+    }
+
+    // Waits until workers worker - 1 and worker + 1 (where they exist) have
+    // finished the given round
+    void waitForNeighbours(int worker, long round) const {
+        SORT_TRACE_BEGIN("wait", round);
+        if (worker > 0) {
+            waitFor(worker - 1, round);
+        }
+        if (worker + 1 < static_cast<int>(rounds.size())) {
+            waitFor(worker + 1, round);
+        }
+        SORT_TRACE_END("wait", round);
+    }
+
+private:
+    // Padded so neighbouring workers do not share a cache line
+    struct PaddedRound {
+        std::atomic<long> value;
+        char pad[56];
+    };
+
+    void waitFor(int worker, long round) const {
+        int spins = 0;
+        while (rounds[worker].value.load(std::memory_order_acquire) < round) {
+            // Back off like the barrier, a neighbour may be waiting for a core
+            if (++spins > 1024) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::vector<PaddedRound> rounds;
+};
+
+// Pins the calling thread to the given logical core (no-op outside Linux)
+inline void pinThreadToCore(int core) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+// Fixed pool of P workers reused across sort calls. The calling thread acts as
+// worker 0, the remaining P - 1 threads are created once. Pinned workers take
+// the cores node by node (numaCoreOrder), so worker w, which owns chunk or
+// block w, sits next to its neighbours and only the workers at a node
+// boundary work across sockets. The caller is pinned as worker 0 only while
+// a job runs and gets its own affinity back before run() returns, so threads
+// it starts between jobs (which inherit its mask) are not tied to one core.
+// A job runs the whole round loop on every worker, and workers synchronise
+// with barrier() at the end of each round instead of being joined.
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads = 0, bool pin = true)
+        : numWorkers(threads > 0 ? threads : defaultThreadCount()),
+          roundBarrier(numWorkers), senses(numWorkers),
+          job(nullptr), generation(0), stopping(false), pinned(pin) {
+        SORT_TRACE_NAME("worker 0");
+        std::vector<int> order = numaCoreOrder();
+        for (int w = 0; w < numWorkers; w++) {
+            int core = order[w % order.size()];
+            cores.push_back(core);
+            nodes.push_back(numaTopology().cpuNode[core]);
+        }
+        for (int w = 1; w < numWorkers; w++) {
+            int core = cores[w];
+            workers.push_back(std::thread([this, w, pin, core]() {
+                SORT_TRACE_NAME("worker " + std::to_string(w));
+                if (pin) {
+                    pinThreadToCore(core);
+                }
+                workerLoop(w);
+            }));
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int size() const { return numWorkers; }
+
+    // Runs job(worker) on every worker and returns once all of them finished
+    void run(const std::function<void(int)>& task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job = &task;
+            generation++;
+        }
+        wakeup.notify_all();
+#ifdef __linux__
+        cpu_set_t callerAffinity;
+        if (pinned) {
+            CPU_ZERO(&callerAffinity);
+            pthread_getaffinity_np(pthread_self(), sizeof(callerAffinity), &callerAffinity);
+            pinThreadToCore(cores[0]);
+        }
+#endif
+        task(0);
+        barrier(0);
+#ifdef __linux__
+        if (pinned) {
+            pthread_setaffinity_np(pthread_self(), sizeof(callerAffinity), &callerAffinity);
+        }
+#endif
+    }
+
+    // Waits until every worker of the pool has reached the same barrier
+    void barrier(int worker) {
+        SORT_TRACE_BEGIN("barrier", -1);
+        roundBarrier.wait(senses[worker].value);
+        SORT_TRACE_END("barrier", -1);
+    }
+
+    // Contiguous share [begin, end) of count items that belongs to a worker
+    void chunk(long count, int worker, long& begin, long& end) const {
+        long base = count / numWorkers;
+        long extra = count % numWorkers;
+        begin = worker * base + (worker < extra ? worker : extra);
+        end = begin + base + (worker < extra ? 1 : 0);
+    }
+
+    // Core a worker is (or, unpinned, would be) pinned to, and its NUMA node
+    int core(int worker) const { return cores[worker]; }
+    int node(int worker) const { return nodes[worker]; }
+
+    static int defaultThreadCount() {
+        unsigned cores = std::thread::hardware_concurrency();
+        return cores == 0 ? 1 : static_cast<int>(cores);
+    }
+
+private:
+    // Padded so neighbouring workers do not share a cache line
+    struct PaddedSense {
+        bool value = false;
+        char pad[63];
+    };
+
+    void workerLoop(int worker) {
+        unsigned long seen = 0;
+        while (true) {
+            const std::function<void(int)>* task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                wakeup.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                task = job;
+            }
+            (*task)(worker);
+            barrier(worker);
+        }
+    }
+
+    const int numWorkers;
+    SenseBarrier roundBarrier;
+    std::vector<PaddedSense> senses;
+    std::vector<std::thread> workers;
+
+    std::mutex mtx;
+    std::condition_variable wakeup;
+    const std::function<void(int)>* job;
+    unsigned long generation;
+    bool stopping;
+
+    std::vector<int> cores;
+    std::vector<int> nodes;
+    bool pinned;
+};
+
+// Moves the pages of every worker's block of data (block w of ceil(n / p)
+// items, as the block engines split it) to that worker's node, each worker
+// its own block. Nothing to do on a single node. Returns the pages placed,
+// or -1 if the kernel refused to move them.
+template <class T>
+inline long placeBlocks(const T* data, long n, WorkerPool& pool) {
+    if (numaTopology().nodes() < 2 || n == 0) {
+        return 0;
+    }
+    std::vector<long> placed(pool.size());
+    long size = (n + pool.size() - 1) / pool.size();
+    pool.run([&](int worker) {
+        long begin = std::min(n, worker * size), end = std::min(n, begin + size);
+        placed[worker] = movePagesToNode(data + begin, (end - begin) * sizeof(T), pool.node(worker));
+    });
+    long total = 0;
+    for (long pages : placed) {
+        if (pages < 0) {
+            return -1;
+        }
+        total += pages;
+    }
+    return total;
+}
+
+#endif